@@ -50,12 +50,13 @@ class ScytherThread(threading.Thread):
     """
 
     # Override Thread's __init__ method to accept the parameters needed:
-    def __init__ ( self, spdl, options="", callback=None, mode=None ):
+    def __init__ ( self, spdl, options="", callback=None, mode=None, progress=None ):
 
         self.spdl = spdl
         self.options = options
         self.callback = callback
         self.mode = mode
+        self.progress = progress
         self.popenList = []
         threading.Thread.__init__ ( self )
 
@@ -79,6 +80,11 @@ class ScytherThread(threading.Thread):
         if self.callback:
             wx.CallAfter(self.callback, scyther, claims, summary)
 
+    def claimRead(self,claim):
+        # A claim has been verified, while others may still be running
+        if self.progress:
+            wx.CallAfter(self.progress, claim)
+
     def claimFixViewOne(self,claims):
         """
         This is a stupid hack as long as switches.useAttackBuffer in
@@ -113,7 +119,7 @@ class ScytherThread(threading.Thread):
 
         # verification start
         try:
-            claims = scyther.verify(storePopen=self.storePopen)
+            claims = scyther.verify(storePopen=self.storePopen, callback=self.claimRead)
         except Scyther.Error.ScytherError as el:
             claims = None
             pass
@@ -181,7 +187,8 @@ class VerificationWindow(wx.Dialog):
 
         sizer = wx.BoxSizer(wx.VERTICAL)
 
-        label = wx.StaticText(self, -1, "Verifying protocol description")
+        self.claimcount = 0
+        self.label = label = wx.StaticText(self, -1, "Verifying protocol description")
         sizer.Add(label, 0, wx.ALIGN_CENTRE|wx.ALL, 5)
 
         line = wx.StaticLine(self, -1, size=(20,-1), style=wx.LI_HORIZONTAL)
@@ -201,6 +208,11 @@ class VerificationWindow(wx.Dialog):
         self.Center()
         self.Show(True)
 
+    def claimRead(self,claim):
+        self.claimcount += 1
+        self.label.SetLabel("Verifying protocol description (%i claims done)" % (self.claimcount))
+        self.GetSizer().Fit(self)
+
 #---------------------------------------------------------------------------
 
 class ErrorWindow(wx.Dialog):
@@ -475,11 +487,18 @@ class ScytherRun(object):
         self.verifywin.Bind(wx.EVT_WINDOW_DESTROY, self.closer)
         self.verifywin.Bind(wx.EVT_BUTTON, self.closer, id=wx.ID_CANCEL)
 
-        self.SThread = ScytherThread(self.spdl, self.options, self.verificationDone, self.mode)
+        self.SThread = ScytherThread(self.spdl, self.options, self.verificationDone, self.mode, self.claimRead)
         self.SThread.start()
 
         # after verification, we proceed to the callback below...
 
+    def claimRead(self, claim):
+        """
+        Callback from the thread for each claim that has been verified.
+        """
+        if self.verifywin != None:
+            self.verifywin.claimRead(claim)
+
     def verificationDone(self, scyther, claims, summary):
         """
         This is where we end up after a callback from the thread, stating that verification succeeded.
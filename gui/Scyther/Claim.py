@@ -51,6 +51,8 @@ class Claim(object):
         self.states = 0
         self.complete = False
         self.timebound = False
+        self.membound = False
+        self.statebound = None  # --max-states limit, if it was reached
         self.attacks = []
         self.state = False      # if true, it is a state, not an attack
         self.okay = None        # true if good, false if bad
@@ -30,7 +30,9 @@ import os.path
 import sys
 import io
 import tempfile
+import shutil
 import platform
+import time
 
 try:
     import hashlib
@@ -192,6 +194,22 @@ def getScytherBackend():
 
 #---------------------------------------------------------------------------
 
+class CopyingReader(object):
+    """
+    Binary input stream that writes a copy of everything read from it to
+    another stream.
+    """
+    def __init__(self, stream, copy):
+        self.stream = stream
+        self.copy = copy
+
+    def read(self, size=-1):
+        data = self.stream.read(size)
+        self.copy.write(data)
+        return data
+
+#---------------------------------------------------------------------------
+
 class Scyther(object):
     def __init__ ( self):
 
@@ -272,34 +290,22 @@ class Scyther(object):
         for arg in arglist:
             self.options += " %s" % (arg)
 
-    def doScytherCommand(self, spdl, args, checkKnown=False, storePopen=None):
+    def getCacheNames(self, spdl, args):
         """
-        Cached version of the 'real' below
+        Determine where the result of a Scyther call is cached.
 
-        TODO: CC: One possible problem with the caching is the side-effect, e.g., scyther writing to specific named output files. These are not
-        captured in the cache. I don't have a good solution for that yet.
+        Returns (path,fname1,fname2), with the directory and the file
+        names for the output and the errors, or None if the cache cannot
+        be used.
         """
         global HASHLIB
 
-        # Can we use the cache?
-        canCache = False
-        if HASHLIB:
-            cacheDir = getCacheDir()
-            if cacheDir != None:
-                canCache = True
-        else:
-            cacheDir = None
-
-        # If we cannot use the cache, we either need to compute or, if checking for cache presense,...
-        if not canCache:
-            if checkKnown == True:
-                # not using the cache, so we don't have it already
-                return False
-            else:
-                # Need to compute
-                return self.doScytherCommandReal(spdl,args, storePopen=storePopen)
+        if not HASHLIB:
+            return None
+        cacheDir = getCacheDir()
+        if cacheDir == None:
+            return None
 
-        # Apparently we are supporsed to be able to use the cache
         m = hashlib.sha256()
         
         def muppet(m, s):
@@ -332,6 +338,31 @@ class Scyther(object):
         fname1 = os.path.join(path, name1)
         fname2 = os.path.join(path, name2)
 
+        return (path,fname1,fname2)
+
+    def doScytherCommand(self, spdl, args, checkKnown=False, storePopen=None):
+        """
+        Cached version of the 'real' below
+
+        TODO: CC: One possible problem with the caching is the side-effect, e.g., scyther writing to specific named output files. These are not
+        captured in the cache. I don't have a good solution for that yet.
+        """
+
+        # Can we use the cache?
+        cacheNames = self.getCacheNames(spdl, args)
+
+        # If we cannot use the cache, we either need to compute or, if checking for cache presense,...
+        if cacheNames == None:
+            if checkKnown == True:
+                # not using the cache, so we don't have it already
+                return False
+            else:
+                # Need to compute
+                return self.doScytherCommandReal(spdl,args, storePopen=storePopen)
+
+        # Apparently we are supporsed to be able to use the cache
+        (path,fname1,fname2) = cacheNames
+
         try:
             """
             Try to retrieve the result from the cache
@@ -358,8 +389,19 @@ class Scyther(object):
             # We were only checking, abort
             return False
 
+        start = time.time()
         (out,err) = self.doScytherCommandReal(spdl,args, storePopen=storePopen)
+        self.storeCache(cacheNames, out, err)
+        self.storeTime(spdl, args, time.time() - start)
 
+        return (out,err)
+
+    def storeCache(self, cacheNames, out, err):
+        """
+        Store the result of a Scyther call in the cache, at the names
+        returned by getCacheNames.
+        """
+        (path,fname1,fname2) = cacheNames
         try:
             # Try to store result in cache
             ensurePath(path)
@@ -374,7 +416,63 @@ class Scyther(object):
         except:
             pass
 
-        return (out,err)
+    def getTimeName(self, spdl):
+        """
+        Determine where the run times of Scyther calls on the spdl are
+        kept, or None if the cache cannot be used.
+
+        The times are kept per input rather than per call, such that a call
+        that has never been made can be predicted from the same input with
+        other arguments.
+        """
+        cacheNames = self.getCacheNames(spdl, "[time]")
+        if cacheNames == None:
+            return None
+        (path,fname1,fname2) = cacheNames
+        return fname1[:-len(".out")] + ".time"
+
+    def storeTime(self, spdl, args, seconds):
+        """
+        Add a run time to the .time file of the spdl: a line with the
+        seconds and the arguments.
+        """
+        fname = self.getTimeName(spdl)
+        if fname == None:
+            return
+        try:
+            ensurePath(os.path.dirname(fname))
+            fh = open(fname,"a")
+            fh.write("%.3f\t%s\n" % (seconds, args))
+            fh.close()
+        except:
+            pass
+
+    def predictTime(self, spdl, args):
+        """
+        Predict the run time of a Scyther call from the .time file of the
+        spdl. This is the last time for the same arguments, or else the
+        longest time for any arguments. Returns None if nothing is known.
+        """
+        fname = self.getTimeName(spdl)
+        if fname == None or not os.path.isfile(fname):
+            return None
+        exact = None
+        longest = None
+        try:
+            fh = open(fname,"r")
+            for l in fh:
+                (seconds,sep,largs) = l.rstrip("\n").partition("\t")
+                seconds = float(seconds)
+                if largs == args:
+                    exact = seconds
+                if longest == None or seconds > longest:
+                    longest = seconds
+            fh.close()
+        except:
+            return None
+        if exact != None:
+            return exact
+        return longest
 
 
     def doScytherCommandReal(self, spdl, args, storePopen=None):
@@ -450,13 +548,163 @@ class Scyther(object):
 
         return (output,errors)
 
+    def doScytherCommandStream(self, spdl, args, callback, storePopen=None):
+        """
+        Run Scyther backend on the input, and read the XML output while
+        Scyther is still running.
+
+        Arguments:
+            spdl -- string describing the spdl text
+            args -- arguments for the command-line
+            callback -- function called with each Claim object as soon as it has been read
+            storePopen -- callback function to register Popen objects (used for process kill by other threads)
+        Returns:
+            (claims,errors)
+            claims -- list of Claim objects, or None if the output was not valid XML
+            errors -- string which captures the errors
+
+        The output is not kept in memory. It is stored in the cache, if
+        there is one, in the same way as by doScytherCommand.
+        """
+
+        cacheNames = self.getCacheNames(spdl, args)
+        if cacheNames != None:
+            (path,fname1,fname2) = cacheNames
+            if os.path.isfile(fname1) and os.path.isfile(fname2):
+                # Known result, read it from the cache
+                fh2 = open(fname2,"r")
+                errors = fh2.read()
+                fh2.close()
+                fh1 = open(fname1,"rb")
+                claims = self.readClaims(fh1, callback)
+                fh1.close()
+                return (claims,errors)
+
+        if self.program == None:
+            raise Error.NoBinaryError
+
+        # Sanitize input somewhat
+        if spdl == "":
+            # Scyther hickups on completely empty input
+            spdl = "\n"
+
+        # Extract filenames for error reporting later
+        self.guessFileNames(spdl=spdl)
+
+        # Errors go to a temporary file, the output is read from a pipe
+        # and copied to a temporary file for the cache.
+        (fde,fne) = tempfile.mkstemp()  # errors
+        (fdo,fno) = tempfile.mkstemp()  # output
+        fne = os.path.normpath(fne)
+        fno = os.path.normpath(fno)
+
+        if spdl:
+            (fdi,fni) = tempfile.mkstemp()  # input
+            fni = os.path.normpath(fni)
+
+            # Write (input) file
+            fhi = os.fdopen(fdi,'w+')
+            fhi.write(spdl)
+            fhi.close()
+
+        # Generate command line for the Scyther process
+        self.cmd = ""
+        self.cmd += "\"%s\"" % self.program
+        self.cmd += " --append-errors=\"%s\"" % fne
+        self.cmd += " %s" % args
+        if spdl:
+            self.cmd += " \"%s\"" % fni
+
+        # Start the process
+        import shlex
+        import subprocess
+        start = time.time()
+        p = subprocess.Popen(shlex.split(self.cmd), stdout=subprocess.PIPE)
+        if storePopen != None:
+            storePopen(p)
+
+        fho = os.fdopen(fdo,'wb')
+        try:
+            claims = self.readClaims(CopyingReader(p.stdout,fho), callback)
+        finally:
+            # Drain the pipe if we stopped early, and wait for Scyther
+            p.stdout.read()
+            p.wait()
+            fho.close()
+
+        fhe = os.fdopen(fde)
+        errors = fhe.read()
+        fhe.close()
+
+        if cacheNames != None:
+            try:
+                # Try to store result in cache
+                ensurePath(path)
+                shutil.copyfile(fno,fname1)
+
+                fh2 = open(fname2,"w")
+                fh2.write(errors)
+                fh2.close()
+            except:
+                pass
+            self.storeTime(spdl, args, time.time() - start)
+
+        # clean up files
+        os.remove(fne)
+        os.remove(fno)
+        if spdl:
+            os.remove(fni)
+
+        return (claims,errors)
+
+    def readClaims(self, stream, callback):
+        """
+        Read Claim objects from XML output, calling callback for each one.
+        Returns the list of claims, or None if the output is not valid XML.
+        """
+        claims = []
+        reader = XMLReader.XMLReader()
+        try:
+            for claim in reader.iterXML(stream):
+                claims.append(claim)
+                callback(claim)
+        except XMLReader.ParseError:
+            # Typically no output at all, because of errors
+            return None
+        return claims
+
     def sanitize(self):
         """ Sanitize some of the input """
         self.options = EnsureString(self.options)
 
-    def verify(self,extraoptions=None,checkKnown=False,storePopen=None):
+    def verify(self,extraoptions=None,checkKnown=False,storePopen=None,callback=None):
         """ Should return a list of results """
         """ If checkKnown == True, we do not call Scyther, but just check the cache, and return True iff the result is in the cache """
+        """ If callback is given, the XML output is read while Scyther runs, and callback is called with each Claim object as soon as it is known """
+
+        args = self.getArgs(extraoptions)
+
+        # Are we only checking the cache?
+        if checkKnown == True:
+            return self.doScytherCommand(self.spdl, args, checkKnown=checkKnown, storePopen=storePopen)
+
+        # execute
+        claims = None
+        if self.xml and callback != None:
+            (claims,errors) = self.doScytherCommandStream(self.spdl, args, callback, storePopen=storePopen)
+            output = ""
+        else:
+            (output,errors) = self.doScytherCommand(self.spdl, args, storePopen=storePopen)
+        self.processOutput(output, errors, claims)
+
+        # Determine what should be the result
+        if self.xml:
+            return self.claims
+        else:
+            return self.output
+
+    def getArgs(self, extraoptions=None):
+        """ Command-line arguments for the backend, as used by verify """
 
         # Cleanup first
         self.sanitize()
@@ -469,13 +717,16 @@ class Scyther(object):
         if extraoptions:
             # extraoptions might need sanitizing
             args += " %s" % EnsureString(extraoptions)
+        return args
 
-        # Are we only checking the cache?
-        if checkKnown == True:
-            return self.doScytherCommand(self.spdl, args, checkKnown=checkKnown, storePopen=storePopen)
+    def processOutput(self, output, errors, claims=None):
+        """
+        Interpret the output and errors of the backend, as for verify.
 
-        # execute
-        (output,errors) = self.doScytherCommand(self.spdl, args, storePopen=storePopen)
+        If claims is not None, the XML output has already been read into
+        this list of Claim objects.
+        """
+        streamed = (claims != None)
         self.run = True
 
         # process errors
@@ -504,7 +755,10 @@ class Scyther(object):
         self.output = output
         self.validxml = False
         self.claims = []
-        if self.xml:
+        if streamed:
+            self.validxml = True
+            self.claims = claims
+        elif self.xml:
             if len(output) > 0:
                 if output.startswith("<scyther>"):
 
@@ -515,12 +769,6 @@ class Scyther(object):
                     reader = XMLReader.XMLReader()
                     self.claims = reader.readXML(xmlfile)
 
-        # Determine what should be the result
-        if self.xml:
-            return self.claims
-        else:
-            return self.output
-
     def verifyOne(self,cl=None,checkKnown=False,storePopen=None):
         """
         Verify just a single claim with an ID retrieved from the
@@ -574,6 +822,132 @@ class Scyther(object):
 
 #---------------------------------------------------------------------------
 
+def verifyManyWorker(program, spdl, args, timeout):
+    """
+    Run a single backend call for verifyMany, in a worker process.
+
+    Returns (output,errors,seconds,timedout). If the call takes more than
+    timeout seconds, the backend is killed and the output is incomplete.
+    """
+    import threading
+
+    sc = Scyther()
+    sc.program = program
+    timers = []
+    killed = []
+
+    def kill(p):
+        killed.append(p)
+        p.kill()
+
+    def storePopen(p):
+        if timeout != None:
+            timer = threading.Timer(timeout, kill, [p])
+            timers.append(timer)
+            timer.start()
+
+    start = time.time()
+    try:
+        (output,errors) = sc.doScytherCommandReal(spdl, args, storePopen=storePopen)
+    finally:
+        for timer in timers:
+            timer.cancel()
+    seconds = time.time() - start
+    return (output, errors, seconds, len(killed) > 0)
+
+def verifyMany(jobs, workers=None, timeout=None, extraoptions=None):
+    """
+    Verify a list of Scyther objects, set up as for verify, in parallel.
+
+    This is a generator that yields (job,result) pairs as the results come
+    in. The result is what job.verify(extraoptions) would return, the
+    Error.ScytherError it would raise, or None if the job took more than
+    timeout seconds.
+
+    Jobs with the same input and arguments are run only once, and jobs
+    whose result is in the cache are not run at all; they come first. The
+    other jobs are run by a pool of worker processes (by default one per
+    core), the longest first, as predicted from the run times in the cache.
+    Jobs that were never run before count as the longest.
+
+    Results of jobs that timed out are not cached, but their run time is,
+    such that they are started early in the next batch.
+
+    On platforms that start worker processes by importing the main module
+    (Windows, and OS X by default), the caller must be protected by
+    if __name__ == '__main__'.
+    """
+    import concurrent.futures
+
+    # Group the jobs with the same backend call
+    groups = {}
+    order = []
+    for job in jobs:
+        key = (job.spdl, job.getArgs(extraoptions))
+        if key not in groups:
+            groups[key] = []
+            order.append(key)
+        groups[key].append(job)
+
+    def results(key, output, errors):
+        for job in groups[key]:
+            try:
+                job.processOutput(output, errors)
+            except Error.ScytherError as e:
+                yield (job, e)
+                continue
+            if job.xml:
+                yield (job, job.claims)
+            else:
+                yield (job, job.output)
+
+    # Known results first
+    todo = []
+    for key in order:
+        (spdl,args) = key
+        sc = groups[key][0]
+        if sc.doScytherCommand(spdl, args, checkKnown=True):
+            (output,errors) = sc.doScytherCommand(spdl, args)
+            for res in results(key, output, errors):
+                yield res
+        else:
+            todo.append(key)
+    if len(todo) == 0:
+        return
+
+    # Longest first
+    def predicted(key):
+        seconds = groups[key][0].predictTime(key[0], key[1])
+        if seconds == None:
+            return float("inf")
+        return seconds
+    todo.sort(key=predicted, reverse=True)
+
+    with concurrent.futures.ProcessPoolExecutor(max_workers=workers) as pool:
+        futures = {}
+        for key in todo:
+            (spdl,args) = key
+            future = pool.submit(verifyManyWorker, groups[key][0].program,
+                    spdl, args, timeout)
+            futures[future] = key
+        for future in concurrent.futures.as_completed(futures):
+            key = futures[future]
+            (spdl,args) = key
+            sc = groups[key][0]
+            (output,errors,seconds,timedout) = future.result()
+            sc.storeTime(spdl, args, seconds)
+            if timedout:
+                for job in groups[key]:
+                    yield (job, None)
+                continue
+            cacheNames = sc.getCacheNames(spdl, args)
+            if cacheNames != None:
+                sc.storeCache(cacheNames, output, errors)
+            for res in results(key, output, errors):
+                yield res
+
+#---------------------------------------------------------------------------
+
 def GetClaims(filelist, filterlist=None):
     """
     Given a list of file names in filelist,
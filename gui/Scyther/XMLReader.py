@@ -54,6 +54,11 @@ Note that you can still use the Scyther binaries in the 'Bin' directory.
 #useiter = False 
 #from elementtree import ElementTree
 
+if useiter:
+    ParseError = cElementTree.ParseError
+else:
+    ParseError = getattr(ElementTree, "ParseError", SyntaxError)
+
 from . import Term
 from . import Attack
 from . import Trace
@@ -72,22 +77,35 @@ class XMLReader(object):
         pass
 
     def readXML(self, input):
-        # Use iter parse when possble so we can clear the attack after reading 
-        # it in order to preserve memory (this requires cElementTree)
+        """
+        Read the complete output, and return the list of Claim objects.
+        """
+        return list(self.iterXML(input))
+
+    def iterXML(self, input):
+        """
+        Read the output incrementally, yielding each Claim object as soon as
+        its <claimstatus> has been read, with the attacks that precede it.
 
+        input can be any file-like object, such as the output pipe of a
+        running Scyther process. When possible, elements are discarded
+        after reading them, so memory use does not grow with the number of
+        claims and attacks.
+        """
         attackbuffer = []
-        claims = []
+        root = None
         
         if useiter:
-            parser = cElementTree.iterparse(input)
+            parser = cElementTree.iterparse(input, events=('start','end'))
         else:
-            parser = ElementTree.parse(input).findall('*')
+            parser = [('end',elem) for elem in ElementTree.parse(input).findall('*')]
 
-        for elem in parser:
-            # The iter parser receives the input in tuples (event and element)
-            # we only need the event
-            if useiter:
-                elem = elem[1]
+        for (event,elem) in parser:
+            if event == 'start':
+                # Remember the <scyther> element, to drop what was read
+                if root == None:
+                    root = elem
+                continue
 
             if elem.tag == 'state':
                 attack = self.readAttack(elem)
@@ -95,10 +113,9 @@ class XMLReader(object):
                 if useiter:
                     elem.clear()
 
-            if elem.tag == 'claimstatus':
+            elif elem.tag == 'claimstatus':
                 claim = self.readClaim(elem)
                 claim.attacks = attackbuffer
-                claims.append(claim)
 
                 # link to parent
                 for attack in claim.attacks:
@@ -106,9 +123,10 @@ class XMLReader(object):
 
                 attackbuffer = []
                 if useiter:
-                    elem.clear()
+                    # Everything read so far can go
+                    root.clear()
 
-        return claims
+                yield claim
 
     # Read a term from XML
     def readTerm(self,xml):
@@ -270,6 +288,10 @@ class XMLReader(object):
                 claim.complete = True
             elif event.tag == 'timebound':
                 claim.timebound = True
+            elif event.tag == 'membound':
+                claim.membound = True
+            elif event.tag == 'statebound':
+                claim.statebound = int(event.text)
             else:
                 print("Warning unknown tag in claim: %s" % claim.tag, file=sys.stderr)
 
@@ -13,6 +13,8 @@ Arguments:
   [2] Step count: how many verification tasks go into one job
   [3] Additional commands to send to bsub (e.g. "-W 1:00")
 
+Without an LSF cluster, use run-jobs.py to run the jobs on the local machine.
+
 """
 
 def countlines(fn):
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+	Scyther : An automatic verifier for security protocols.
+	Copyright (C) 2007-2025 Cas Cremers
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+"""
+
+"""
+Run a file of Scyther verification jobs on this machine.
+
+The job file has the format used by json-scyther.py and make-bsub.py: one
+JSON list [protocollist, options, filter] per line, as written by
+test-mpa.py --pickle. Each job is run as Scyther.verifyOne(filter) would
+run it, and the result is stored in the cache (see getCacheDir), where the
+verification scripts find it afterwards.
+
+Jobs are admitted to the workers in order of their predicted run time,
+longest first, as long as the memory bounds of the running jobs (their
+--max-memory option, or --job-memory) fit in the memory budget. With a
+deadline, jobs whose time bound (-T/--timer) or predicted run time does not
+fit in the remaining time are skipped.
+
+Finished jobs are recorded in a checkpoint file, such that an interrupted
+run continues where it stopped when it is started again. Jobs killed by
+--timeout are recorded too, but run again unless --skip-timeouts is given.
+
+Example:
+
+    ./test-mpa.py --pickle mpa-tests.json -A Protocols/MultiProtocolAttacks/*.spdl
+    ./run-jobs.py -j 8 --memory=16000 mpa-tests.json
+    ./test-mpa.py -A Protocols/MultiProtocolAttacks/*.spdl
+"""
+
+import argparse
+import concurrent.futures
+import json
+import os
+import shlex
+import sys
+import time
+
+from Scyther import Scyther
+
+
+def readJobs(fn, program=None):
+    """ List of (line number, Scyther object, filter) for the job file """
+    res = []
+    ln = 0
+    for l in open(fn, 'r'):
+        ln = ln + 1
+        if len(l.strip()) == 0:
+            continue
+        (protocollist, options, filt) = json.loads(l)
+        s = Scyther.Scyther()
+        if program is not None:
+            s.program = program
+        s.options = str(options)
+        for protocol in sorted(protocollist):
+            s.addFile(protocol)
+        res.append((ln, s, filt))
+    return res
+
+
+def bounds(options):
+    """ The time bound (seconds) and memory bound (MB) in the options """
+    timer = None
+    memory = None
+    args = shlex.split(options)
+    for i in range(len(args)):
+        arg = args[i]
+        val = None
+        if arg in ("-T", "--timer", "--max-memory") and i + 1 < len(args):
+            val = args[i + 1]
+        elif "=" in arg:
+            (arg, sep, val) = arg.partition("=")
+        elif arg.startswith("-T") and len(arg) > 2:
+            (arg, val) = ("-T", arg[2:])
+        try:
+            if arg in ("-T", "--timer"):
+                timer = int(val)
+            elif arg == "--max-memory":
+                memory = int(val)
+        except (TypeError, ValueError):
+            pass
+    return (timer, memory)
+
+
+def physicalMemory():
+    """ Physical memory in MB, or None if unknown """
+    try:
+        pages = os.sysconf("SC_PHYS_PAGES")
+        pagesize = os.sysconf("SC_PAGE_SIZE")
+        return int(pages * pagesize / (1024 * 1024))
+    except (ValueError, OSError, AttributeError):
+        return None
+
+
+class Job(object):
+    """ A backend call, shared by the job lines that need the same one """
+
+    def __init__(self, sc, spdl, args, opts):
+        self.sc = sc
+        self.spdl = spdl
+        self.args = args
+        self.lines = []
+        (self.timer, memory) = bounds(sc.options)
+        self.memory = memory if memory is not None else opts.job_memory
+        self.predicted = sc.predictTime(spdl, args)
+        if self.timer is not None and self.timer > 0:
+            if self.predicted is None or self.predicted > self.timer:
+                self.predicted = self.timer
+
+    def order(self):
+        """ Sort key: longest first, never run before counts as longest """
+        if self.predicted is None:
+            return float("inf")
+        return self.predicted
+
+
+class Checkpoint(object):
+    """
+    Line numbers of the finished jobs, kept in a file.
+
+    Jobs that timed out have no cached result, so they only count as
+    finished with skiptimeouts.
+    """
+
+    def __init__(self, fn, restart, skiptimeouts=False):
+        self.fn = fn
+        self.done = set()
+        self.skiptimeouts = skiptimeouts
+        if restart and os.path.exists(fn):
+            os.remove(fn)
+        if os.path.exists(fn):
+            for l in open(fn, 'r'):
+                fields = l.split("\t")
+                if len(fields) >= 2:
+                    if fields[1] == "timeout" and not skiptimeouts:
+                        continue
+                    self.done.add(int(fields[0]))
+        self.fh = open(fn, 'a')
+
+    def add(self, job, status, seconds):
+        for ln in job.lines:
+            self.fh.write("%i\t%s\t%.3f\n" % (ln, status, seconds))
+            self.done.add(ln)
+        self.fh.flush()
+        os.fsync(self.fh.fileno())
+
+    def close(self):
+        self.fh.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("jobfile", help="file with JSON job lines")
+    parser.add_argument("--scyther", default=None,
+                        help="backend binary [%s]" %
+                        (Scyther.getScytherBackend()))
+    parser.add_argument("-j", "--workers", type=int, default=os.cpu_count(),
+                        help="number of jobs to run at once [%(default)s]")
+    parser.add_argument("--memory", type=int, default=physicalMemory(),
+                        help="memory budget in MB for the running jobs "
+                        "[%(default)s]")
+    parser.add_argument("--job-memory", type=int, default=0,
+                        help="memory in MB of a job without --max-memory "
+                        "[%(default)s]")
+    parser.add_argument("--timeout", type=float, default=None,
+                        help="kill a job after this many seconds (wall "
+                        "clock); the result is not cached")
+    parser.add_argument("--deadline", type=float, default=None,
+                        help="only start jobs that can finish within this "
+                        "many seconds from now")
+    parser.add_argument("--checkpoint", default=None,
+                        help="checkpoint file [JOBFILE.done]")
+    parser.add_argument("--restart", action="store_true",
+                        help="ignore the checkpoint and start over")
+    parser.add_argument("--skip-timeouts", action="store_true",
+                        help="do not run jobs again that timed out before")
+    opts = parser.parse_args()
+    if opts.checkpoint is None:
+        opts.checkpoint = opts.jobfile + ".done"
+    if Scyther.getCacheDir() is None:
+        print("The cache is disabled (SCYTHERCACHEDIR is empty), so the "
+              "results would be lost.")
+        return 1
+
+    start = time.time()
+    checkpoint = Checkpoint(opts.checkpoint, opts.restart,
+                            opts.skip_timeouts)
+
+    # Group the lines by backend call, skipping what is known already
+    jobs = {}
+    cached = 0
+    for (ln, sc, filt) in readJobs(opts.jobfile, opts.scyther):
+        if ln in checkpoint.done:
+            continue
+        if filt:
+            args = sc.getArgs("--filter=%s" % filt)
+        else:
+            args = sc.getArgs()
+        key = (sc.spdl, args)
+        if key not in jobs:
+            jobs[key] = Job(sc, sc.spdl, args, opts)
+        jobs[key].lines.append(ln)
+    pending = []
+    for job in jobs.values():
+        if job.sc.doScytherCommand(job.spdl, job.args, checkKnown=True):
+            checkpoint.add(job, "cached", 0)
+            cached = cached + len(job.lines)
+        else:
+            pending.append(job)
+    pending.sort(key=Job.order, reverse=True)
+    total = len(pending)
+    print("%i jobs finished before, %i cached, %i to run." %
+          (len(checkpoint.done) - cached, cached, total))
+
+    running = {}
+    memory = 0
+    finished = 0
+    skipped = 0
+    with concurrent.futures.ProcessPoolExecutor(opts.workers) as pool:
+        while len(pending) > 0 or len(running) > 0:
+            # Admit the next jobs, in order
+            while len(pending) > 0 and len(running) < opts.workers:
+                job = pending[0]
+                if opts.deadline is not None and job.predicted is not None:
+                    left = opts.deadline - (time.time() - start)
+                    if job.predicted > left:
+                        pending.pop(0)
+                        skipped = skipped + 1
+                        continue
+                if opts.memory is not None and len(running) > 0 and \
+                        memory + job.memory > opts.memory:
+                    break
+                pending.pop(0)
+                future = pool.submit(Scyther.verifyManyWorker,
+                                     job.sc.program, job.spdl, job.args,
+                                     opts.timeout)
+                running[future] = job
+                memory = memory + job.memory
+            if len(running) == 0:
+                break
+
+            (done, notdone) = concurrent.futures.wait(
+                running, return_when=concurrent.futures.FIRST_COMPLETED)
+            for future in done:
+                job = running.pop(future)
+                memory = memory - job.memory
+                (output, errors, seconds, timedout) = future.result()
+                job.sc.storeTime(job.spdl, job.args, seconds)
+                if timedout:
+                    status = "timeout"
+                else:
+                    cacheNames = job.sc.getCacheNames(job.spdl, job.args)
+                    job.sc.storeCache(cacheNames, output, errors)
+                    status = "done"
+                checkpoint.add(job, status, seconds)
+                finished = finished + 1
+                print("%i/%i: line %s %s in %.1fs, %i running, %i left" %
+                      (finished, total, ",".join(map(str, job.lines)),
+                       status, seconds, len(running), len(pending)))
+                sys.stdout.flush()
+    checkpoint.close()
+
+    if skipped > 0:
+        print("Skipped %i jobs that would not finish before the deadline." %
+              (skipped))
+    print("Finished %i jobs in %.1fs." % (finished, time.time() - start))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
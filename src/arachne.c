@@ -59,8 +59,16 @@
 #include "hidelevel.h"
 #include "depend.h"
 #include "xmlout.h"
+#include "jsonout.h"
 #include "heuristic.h"
+#include "restart.h"
+#include "snapshot.h"
 #include "tempfile.h"
+#include "stats.h"
+#include "profile.h"
+#include "timeline.h"
+#include "progress.h"
+#include "cache.h"
 
 extern int *graph;
 extern int nodes;
@@ -82,13 +90,33 @@ int max_encryption_level;	//!< Maximum encryption level of any term
 static int indentDepth;
 static int prevIndentDepth;
 static int indentDepthChanges;
-static FILE *attack_stream;
+//! Cheapest attack so far, when attacks are buffered
+static Snapshot attack_snapshot;
+
+//! Initial intruder knowledge as a single tuple, shared by all claims
+static Term m0term;
+
+//! Memoized result of knowledgeAtArachne()
+struct knowmemo
+{
+  int run;			//!< Run of the event, or -1 for any event
+  int index;			//!< Index of the event, or -1 for any event
+  int aftercomplete;		//!< Parameter of knowledgeAtArachne()
+  Knowledge know;		//!< Resulting knowledge
+  struct knowmemo *next;	//!< Next memo
+};
+
+//! Memo list; only used while rendering a single attack
+static struct knowmemo *knowmemo_list;
+//! True iff the semitrace is frozen and knowledgeAtArachne() may be memoized
+static int knowmemo_active;
 
 /*
  * Forward declarations
  */
 
 int iterate ();
+void knowledgeMemoFlush (void);
 
 /*
  * Program code
@@ -153,12 +181,28 @@ arachneInit (const System mysys)
 
   sys->num_regular_runs = 0;
   sys->num_intruder_runs = 0;
+  sys->num_initiator_runs = 0;
+  sys->num_intruder_actions = 0;
+  sys->semitrace_length = 0;
+  sys->regular_steps = 0;
   max_encryption_level = 0;
 
   indentDepth = 0;
   prevIndentDepth = 0;
   indentDepthChanges = 0;
 
+  m0term = NULL;
+  knowmemo_list = NULL;
+  knowmemo_active = false;
+
+  if (switches.heuristicProfile != NULL)
+    {
+      heuristicProfileLoad (switches.heuristicProfile);
+    }
+  profileInit ();
+  progressInit (sys);
+  cacheInit (sys);
+
   return;
 }
 
@@ -166,6 +210,11 @@ arachneInit (const System mysys)
 void
 arachneDone ()
 {
+  knowledgeMemoFlush ();
+  heuristicProfileDone ();
+  profileDone ();
+  progressDone ();
+  cacheDone ();
   return;
 }
 
@@ -320,6 +369,22 @@ isPossiblySent (Term t)
   return isKeylevelRight (t, 0);
 }
 
+//! Set the height of a run
+/**
+ * Keeps the semitrace length and step counters up to date; all height
+ * changes of runs in the semistate should go through here.
+ */
+void
+setRunHeight (const int run, const int height)
+{
+  if (sys->runs[run].protocol != INTRUDER)
+    {
+      sys->semitrace_length += height - sys->runs[run].height;
+      sys->regular_steps += height - sys->runs[run].height;
+    }
+  sys->runs[run].height = height;
+}
+
 //! Wrapper for roleInstance
 /**
  *@return Returns the run number
@@ -330,9 +395,16 @@ semiRunCreate (const Protocol p, const Role r)
   int run;
 
   if (p == INTRUDER)
-    sys->num_intruder_runs++;
+    {
+      sys->num_intruder_runs++;
+      if (r != I_M)
+	sys->num_intruder_actions++;
+    }
   else
     sys->num_regular_runs++;
+  if (r->initiator)
+    sys->num_initiator_runs++;
+  r->created++;
 #ifdef DEBUG
   if (DEBUGL (5))
     {
@@ -348,6 +420,11 @@ semiRunCreate (const Protocol p, const Role r)
   roleInstance (sys, p, r, NULL, NULL);
   run = sys->maxruns - 1;
   sys->runs[run].height = 0;
+  if (p != INTRUDER)
+    {
+      // Matches get_semitrace_length, which subtracts the prefixed events.
+      sys->semitrace_length -= sys->runs[run].firstReal;
+    }
   return run;
 }
 
@@ -358,13 +435,28 @@ semiRunDestroy ()
   if (sys->maxruns > 0)
     {
       Protocol p;
+      Role r;
+      int run;
 
-      p = sys->runs[sys->maxruns - 1].protocol;
-      roleInstanceDestroy (sys);
+      run = sys->maxruns - 1;
+      p = sys->runs[run].protocol;
+      r = sys->runs[run].role;
       if (p == INTRUDER)
-	sys->num_intruder_runs--;
+	{
+	  sys->num_intruder_runs--;
+	  if (r != I_M)
+	    sys->num_intruder_actions--;
+	}
       else
-	sys->num_regular_runs--;
+	{
+	  sys->num_regular_runs--;
+	  sys->semitrace_length -=
+	    sys->runs[run].height - sys->runs[run].firstReal;
+	  sys->regular_steps -= sys->runs[run].height;
+	}
+      if (r->initiator)
+	sys->num_initiator_runs--;
+      roleInstanceDestroy (sys);
     }
 }
 
@@ -419,7 +511,7 @@ add_recv_goals (const int run, const int old, const int new)
       int i;
       Roledef rd;
 
-      sys->runs[run].height = new;
+      setRunHeight (run, new);
       i = old;
       rd = eventRoledef (sys, run, i);
       count = 0;
@@ -457,47 +549,18 @@ add_recv_goals (const int run, const int old, const int new)
 int
 get_semitrace_length ()
 {
-  int run;
-  int length;
-
-  run = 0;
-  length = 0;
-  while (run < sys->maxruns)
-    {
-      if (sys->runs[run].protocol != INTRUDER)
-	{
-	  // Non-intruder run: count length
-	  // Subtract 'firstReal' to ignore chooses.
-	  length = length + sys->runs[run].height - sys->runs[run].firstReal;
-	}
-      run++;
-    }
-  return length;
+  // Sum over the non-intruder runs of their height, minus 'firstReal' to
+  // ignore chooses. Maintained by semiRunCreate, semiRunDestroy and
+  // setRunHeight.
+  return sys->semitrace_length;
 }
 
 //! Count intruder events
 int
 countIntruderActions ()
 {
-  int count;
-  int run;
-
-  count = 0;
-  run = 0;
-  while (run < sys->maxruns)
-    {
-      if (sys->runs[run].protocol == INTRUDER)
-	{
-	  // Only intruder roles
-	  if (sys->runs[run].role != I_M)
-	    {
-	      // The M_0 (initial knowledge) events don't count.
-	      count++;
-	    }
-	}
-      run++;
-    }
-  return count;
+  // Intruder runs, except for the M_0 (initial knowledge) ones.
+  return sys->num_intruder_actions;
 }
 
 //------------------------------------------------------------------------
@@ -762,7 +825,7 @@ create_decryptor (const Term term, const Term key)
       rd->message = termDuplicateUV (term);
       rd->next->message = termDuplicateUV (key);
       rd->next->next->message = termDuplicateUV (TermOp (term));
-      sys->runs[run].height = 3;
+      setRunHeight (run, 3);
       proof_suppose_run (run, 0, 3);
 
       return run;
@@ -1085,7 +1148,7 @@ unifiesWithKeys (Termlist substlist, Termlist keylist,
 
   // undo
   goal_remove_last (newgoals);
-  sys->runs[ptr_betgState->run].height = old_length;
+  setRunHeight (ptr_betgState->run, old_length);
   return true;
 }
 
@@ -1535,6 +1598,16 @@ process_good_candidate (const Protocol p, const Role r, const Roledef rd,
 			const int index, const Binding b, const int found)
 {
   int sflag;
+  struct profilemark mark;
+  Profilesend ps;
+
+  ps = NULL;
+  if (switches.profile > 0)
+    {
+      ps = profileSendEnter (p, r, rd, index);
+      profileStart (sys, &mark);
+    }
+  progressSend (rd);
 
   // A good candidate
   proof_term_match_first (found, b);
@@ -1558,6 +1631,10 @@ process_good_candidate (const Protocol p, const Role r, const Roledef rd,
   proof_go_up ();
 
   indentDepth--;
+  if (switches.profile > 0)
+    {
+      profileSendLeave (sys, ps, &mark);
+    }
   return sflag;
 }
 
@@ -1596,6 +1673,100 @@ bind_this_role_send (Protocol p, Role r, Roledef rd, int index,
     }
 }
 
+//! Candidate send for a regular goal
+struct candidate_brs
+{
+  Protocol p;
+  Role r;
+  Roledef rd;
+  int index;
+};
+
+//! Helper struct to collect candidates for randomized binding
+struct state_crs
+{
+  Binding binding;
+  struct candidate_brs *list;
+  int count;
+  int max;
+};
+
+//! Helper for bind_goal_regular_run: collect instead of bind
+int
+collect_this_role_send (Protocol p, Role r, Roledef rd, int index,
+			struct state_crs *cs)
+{
+  if (p == INTRUDER)
+    {
+      // No intruder roles here
+      return true;
+    }
+
+  debug_send_candidate (p, r, rd, index);
+
+  if (!subtermUnify
+      (rd->message, (cs->binding)->term, NULL, NULL, test_sub_unification,
+       NULL))
+    {
+      if (cs->count == cs->max)
+	{
+	  cs->max = (cs->max == 0) ? 8 : 2 * cs->max;
+	  cs->list = (struct candidate_brs *)
+	    realloc (cs->list, cs->max * sizeof (struct candidate_brs));
+	}
+      cs->list[cs->count].p = p;
+      cs->list[cs->count].r = r;
+      cs->list[cs->count].rd = rd;
+      cs->list[cs->count].index = index;
+      cs->count++;
+    }
+  return true;
+}
+
+//! Bind a regular goal, trying the candidates in random order
+/**
+ * Used during randomized restarts. The unification test does not depend on
+ * the order, so we can collect the candidates first and shuffle them.
+ */
+int
+bind_goal_regular_run_shuffled (const Binding b)
+{
+  int flag;
+  int i;
+  struct state_crs cs;
+
+  cs.binding = b;
+  cs.list = NULL;
+  cs.count = 0;
+  cs.max = 0;
+  iterate_state_role_sends (collect_this_role_send, &cs);
+
+  // Fisher-Yates
+  for (i = cs.count - 1; i > 0; i--)
+    {
+      struct candidate_brs c;
+      int j;
+
+      j = restartRandom (i + 1);
+      c = cs.list[i];
+      cs.list[i] = cs.list[j];
+      cs.list[j] = c;
+    }
+
+  flag = true;
+  for (i = 0; flag && i < cs.count; i++)
+    {
+      struct candidate_brs *c;
+
+      c = &cs.list[i];
+      flag = process_good_candidate (c->p, c->r, c->rd, c->index, b, i + 1);
+    }
+  free (cs.list);
+
+  proof_term_match_none (b, cs.count);
+  return flag;
+}
+
 //! Bind a regular goal
 /**
  * Problem child. Valgrind did not like it. 
@@ -1607,6 +1778,11 @@ bind_goal_regular_run (const Binding b)
   int flag;
   struct state_brs bs;
 
+  if (restart_randomize)
+    {
+      return bind_goal_regular_run_shuffled (b);
+    }
+
   // Bind to all possible sends of regular runs
   bs.found = 0;
   bs.binding = b;
@@ -1677,11 +1853,20 @@ bind_goal_all_options (const Binding b)
   if (!b->done)
     {
       int flag;
+      struct profilemark mark;
+      Profilegoal pg;
 
       flag = 1;
+      pg = NULL;
       proof_select_goal (b);
       indentDepth++;
 
+      if (switches.profile > 0)
+	{
+	  pg = profileGoalEnter (b->term);
+	  profileStart (sys, &mark);
+	}
+
       // Consider a duplicate goal that we already bound before (C-minimality)
       // if (1 == 0)
       if (bind_old_goal (b))
@@ -1699,6 +1884,11 @@ bind_goal_all_options (const Binding b)
 
 	  // Unbind again
 	  goal_unbind (b);
+	  if (switches.profile > 0)
+	    {
+	      profileGoal (sys, pg, PROFILE_OLD_GOAL, &mark);
+	      profileGoalLeave (pg);
+	    }
 	  indentDepth--;
 	  return flag;
 	}
@@ -1785,6 +1975,7 @@ bind_goal_all_options (const Binding b)
 	  // Allright, proceed
 
 	  proofDepth++;
+	  progressGoal (know_only);
 	  if (know_only)
 	    {
 	      // Special case: only from intruder
@@ -1792,19 +1983,43 @@ bind_goal_all_options (const Binding b)
 	      flag = flag && bind_goal_old_intruder_run (b);
 	      //flag = flag && bind_goal_new_intruder_run (b);
 	      proof_go_up ();
+	      if (switches.profile > 0)
+		{
+		  profileGoal (sys, pg, PROFILE_OLD_INTRUDER, &mark);
+		}
 	    }
 	  else
 	    {
 	      // Normal case
 	      flag = bind_goal_regular_run (b);
+	      if (switches.profile > 0)
+		{
+		  profileGoal (sys, pg, PROFILE_REGULAR, &mark);
+		  profileStart (sys, &mark);
+		}
+	      progressIntruder (false);
 	      proof_go_down (TERM_CoOld, b->term);
 	      flag = flag && bind_goal_old_intruder_run (b);
 	      proof_go_up ();
+	      if (switches.profile > 0)
+		{
+		  profileGoal (sys, pg, PROFILE_OLD_INTRUDER, &mark);
+		  profileStart (sys, &mark);
+		}
+	      progressIntruder (true);
 	      proof_go_down (TERM_CoNew, b->term);
 	      flag = flag && bind_goal_new_intruder_run (b);
 	      proof_go_up ();
+	      if (switches.profile > 0)
+		{
+		  profileGoal (sys, pg, PROFILE_NEW_INTRUDER, &mark);
+		}
 	    }
 	  proofDepth--;
+	  if (switches.profile > 0)
+	    {
+	      profileGoalLeave (pg);
+	    }
 
 	  indentDepth--;
 	  return flag;
@@ -1846,7 +2061,7 @@ createNewTermGeneric (Termlist tl, Term t)
     }
 
   /* Make a new term with the free number */
-  newterm = (Term) malloc (sizeof (struct term));
+  newterm = makeTerm ();
   memcpy (newterm, t, sizeof (struct term));
   TermRunid (newterm) = freenumber;
 
@@ -1862,7 +2077,7 @@ Termlist
 findUsedConstants (const System sys)
 {
   int run;
-  Termlist tl;
+  Termlist tl, tlscan;
   Termlist tlconst;
 
   tl = NULL;
@@ -1872,16 +2087,15 @@ findUsedConstants (const System sys)
       tl = termlistAddBasics (tl, sys->runs[run].rho);
       tl = termlistAddBasics (tl, sys->runs[run].sigma);
     }
-  while (tl != NULL)
+  for (tlscan = tl; tlscan != NULL; tlscan = tlscan->next)
     {
       Term t;
 
-      t = tl->term;
+      t = tlscan->term;
       if (!realTermVariable (t))
 	{
 	  tlconst = termlistAddNew (tlconst, t);
 	}
-      tl = tl->next;
     }
   termlistDelete (tl);
   return tlconst;
@@ -2041,9 +2255,10 @@ deleteNewTerm (Term t)
   if (TermRunid (t) >= 0)
     {
       /* if it has a positive runid, it did not come from the intruder
-       * knowledge, so it must have been constructed.
+       * knowledge, so it must have been constructed, with its own type list.
        */
-      free (t);
+      termlistDelete (t->stype);
+      termFree (t);
     }
 }
 
@@ -2153,61 +2368,14 @@ useAttackBuffer (void)
   return false;
 }
 
-//! Start attack output
-void
-attackOutputStart (void)
-{
-  if (useAttackBuffer ())
-    {
-      FILE *fd;
-
-      // Close old file (if any)
-      if (attack_stream != NULL)
-	{
-	  fclose (attack_stream);	// this automatically discards the old temporary file
-	}
-      // Create new file
-      fd = (FILE *) scyther_tempfile ();
-      attack_stream = fd;
-      globalStream = (char *) attack_stream;
-    }
-}
-
-//! Stop attack output
-void
-attackOutputStop (void)
-{
-  // Nothing to do, just leave the opened tmpfile
-}
-
-//! Copy one (finite) stream from beginning to end to another
-/**
- * Ugly first implementation, something to improve later (although it is not
- * crucial code in any way)
- */
-void
-fcopy (FILE * fromstream, FILE * tostream)
-{
-  int c;
-
-  // 'Just to be sure'
-  fflush (fromstream);
-  fseek (fromstream, 0, SEEK_SET);
-
-  // Urgh, using the assignment in the loop condition, brrr. Fugly.
-  // Discourage.
-  while ((c = fgetc (fromstream)) != EOF)
-    {
-      fputc (c, tostream);
-    }
-}
-
-//! Output an attack in the desired way
+//! Render the attack in the current semitrace
 void
-arachneOutputAttack ()
+arachneRenderAttack (void)
 {
   Termlist varlist;
 
+  timelineBegin ("attack");
+
   // Make concrete
   if (switches.concrete)
     {
@@ -2218,11 +2386,15 @@ arachneOutputAttack ()
       varlist = NULL;
     }
 
-  // Wrapper for the real output
-  attackOutputStart ();
+  // The semitrace does not change until we are done
+  knowmemo_active = true;
 
   // Generate the output, already!
-  if (switches.xml)
+  if (switches.json)
+    {
+      jsonOutSemitrace (sys);
+    }
+  else if (switches.xml)
     {
       xmlOutSemitrace (sys);
     }
@@ -2231,11 +2403,37 @@ arachneOutputAttack ()
       dotSemiState (sys);
     }
 
-  // End wrapper
-  attackOutputStop ();
+  knowmemo_active = false;
+  knowledgeMemoFlush ();
 
   // Undo concretization
   makeTraceClass (sys, varlist);
+
+  timelineEnd ();
+}
+
+//! Output an attack in the desired way
+/**
+ * When attacks are buffered, a later (cheaper) attack may replace this one,
+ * so we only keep a copy of the semitrace, to be rendered by
+ * iterate_buffer_attacks.
+ */
+void
+arachneOutputAttack ()
+{
+  if (useAttackBuffer ())
+    {
+      // Discard the old attack (if any)
+      if (attack_snapshot != NULL)
+	{
+	  snapshotDelete (attack_snapshot);
+	}
+      attack_snapshot = snapshotTake (sys);
+    }
+  else
+    {
+      arachneRenderAttack ();
+    }
 }
 
 //------------------------------------------------------------------------
@@ -2349,6 +2547,7 @@ iterateOneBinding (void)
       sys->states = statesIncrease (sys->states);
       sys->current_claim->states =
 	statesIncrease (sys->current_claim->states);
+      progressCheck (sys);
 
 		  /**
 		   * Check whether its a final state (i.e. all goals bound)
@@ -2397,17 +2596,18 @@ iterateAgentUnfoldThis (const Term rolevar, const Term agent)
 void
 iterateAgentUnfolding (const System sys, const Term rolevar)
 {
-  Termlist kl;
+  Termlist kl, tl;
   int count;
 
   iterateAgentUnfoldThis (rolevar, AGENT_Eve);
   kl = knowledgeSet (sys->know);
   count = 0;
-  while (kl != NULL && count < switches.agentUnfold)
+  tl = kl;
+  while (tl != NULL && count < switches.agentUnfold)
     {
       Term t;
 
-      t = deVar (kl->term);
+      t = deVar (tl->term);
       if (realTermLeaf (t) && inTermlist (t->stype, TERM_Agent))
 	{
 	  if (!inTermlist (sys->untrusted, t))
@@ -2416,7 +2616,7 @@ iterateAgentUnfolding (const System sys, const Term rolevar)
 	      count++;
 	    }
 	}
-      kl = kl->next;
+      tl = tl->next;
     }
   termlistDelete (kl);
 }
@@ -2497,6 +2697,45 @@ iterate ()
   return flag;
 }
 
+//! Iterate, preceded by randomized restarts if enabled
+/**
+ * Each attempt has a state budget from the restart schedule and breaks ties
+ * randomly. The cheapest attack cost carries over, so later attempts and the
+ * final full search only look for cheaper attacks. An attempt that finishes
+ * within its budget has covered the whole search space, and then we are done.
+ *
+ * Attacks found during attempts are counted for the claim.
+ */
+int
+iterate_restarts (void)
+{
+  Claimlist cl;
+  int complete;
+  int attempt;
+
+  cl = sys->current_claim;
+  complete = cl->complete;
+  for (attempt = 1; attempt <= switches.restarts; attempt++)
+    {
+      int flag;
+
+      if (switches.output == PROOF)
+	{
+	  indentPrint ();
+	  eprintf ("Randomized restart attempt %i.\n", attempt);
+	}
+      restartBegin (attempt, cl->states);
+      flag = iterate ();
+      if (!restartEnd ())
+	{
+	  return flag;
+	}
+      // Only the budget cut this one short; the bounds are checked again below.
+      cl->complete = complete;
+    }
+  return iterate ();
+}
+
 //! Just before starting output of an attack.
 //
 //! A wrapper for the case in which we need to buffer attacks.
@@ -2505,40 +2744,36 @@ iterate_buffer_attacks (void)
 {
   if (useAttackBuffer ())
     {
-      // We are pruning attacks, so they should go into a temporary file.
-      /*
-       * Set up the temporary file pointer
-       */
-      char *buffer;
+      // We are pruning attacks, so only the last one is rendered.
       int result;
 
-      // Push the old situation onto the stack
-      buffer = globalStream;
-
-      // Start stuff
-      attack_stream = NULL;
-      attackOutputStart ();
-
-      // Finally, proceed with iteration procedure
-      result = iterate ();
-
-      /* Now, if it has been set, we need to copy the output to the normal streams.
-       */
-      fcopy (attack_stream, (FILE *) buffer);
-
-      // Close
-      fclose (attack_stream);
-      attack_stream = NULL;
-
-      // Restore
-      globalStream = buffer;
+      attack_snapshot = NULL;
+      result = iterate_restarts ();
+      if (attack_snapshot != NULL)
+	{
+	  char *stream;
+	  FILE *fd;
+
+	  // Render into a buffer, which is written out in one go
+	  stream = globalStream;
+	  fd = scyther_memstream ();
+	  globalStream = (char *) fd;
+	  snapshotInstall (sys, attack_snapshot);
+	  arachneRenderAttack ();
+	  snapshotRemove (sys, attack_snapshot);
+	  globalStream = stream;
+	  scyther_memstream_write (fd, (FILE *) globalStream);
+	  scyther_memstream_close (fd);
+	  snapshotDelete (attack_snapshot);
+	  attack_snapshot = NULL;
+	}
 
       return result;
     }
   else
     {
       // No attack buffering, just output all of them
-      return iterate ();
+      return iterate_restarts ();
     }
 }
 
@@ -2572,6 +2807,8 @@ arachneClaimTest (Claimlist cl)
   cl->complete = 1;
   p = (Protocol) cl->protocol;
   r = (Role) cl->role;
+  timelineBeginClaim (cl);
+  progressClaim (cl);
 
   if (switches.output == PROOF)
     {
@@ -2598,22 +2835,15 @@ arachneClaimTest (Claimlist cl)
 		     * Add initial knowledge node
 		     */
     {
-      Termlist m0tl;
-      Term m0t;
       int m0run;
 
-      m0tl = knowledgeSet (sys->know);
-      if (m0tl != NULL)
+      if (m0term != NULL)
 	{
-	  m0t = termlist_to_tuple (m0tl);
-	  // eprintf("Initial intruder knowledge node for ");
-	  // termPrint(m0t);
-	  // eprintf("\n");
-	  I_M->roledef->message = m0t;
+	  I_M->roledef->message = m0term;
 	  m0run = semiRunCreate (INTRUDER, I_M);
 	  newruns++;
 	  proof_suppose_run (m0run, 0, 1);
-	  sys->runs[m0run].height = 1;
+	  setRunHeight (m0run, 1);
 	}
       else
 	{
@@ -2633,8 +2863,6 @@ arachneClaimTest (Claimlist cl)
       if (m0run != -1)
 	{
 	  // remove initial knowledge node
-	  termDelete (m0t);
-	  termlistDelete (m0tl);
 	  semiRunDestroy ();
 	  newruns--;
 	}
@@ -2673,6 +2901,7 @@ arachneClaimTest (Claimlist cl)
       indentPrint ();
       eprintf ("Proof complete for this claim.\n");
     }
+  timelineEnd ();
 }
 
 //! Arachne single claim inspection
@@ -2685,17 +2914,45 @@ arachneClaim ()
   cl = sys->current_claim;
   if (!isClaimSignal (cl))
     {
+      // Known from an earlier call?
+      if (cacheReplay (sys, cl))
+	{
+	  eflush ();
+	  return true;
+	}
+      cacheCaptureStart (sys, cl);
+
       // Some claims are always true!
       if (!cl->alwaystrue)
 	{
 	  // others we simply test...
+	  if (switches.reportMemory)
+	    {
+	      statsMemoryClaim ();
+	    }
 	  arachneClaimTest (cl);
 	}
+      timelineBegin ("output");
       claimStatusReport (sys, cl);
+      if (switches.profile > 0)
+	{
+	  profileClaim (sys, cl);
+	}
+      if (switches.reportMemory && !cl->alwaystrue)
+	{
+	  statsMemoryReport (sys, cl);
+	}
       if (switches.xml)
 	{
 	  xmlOutClaim (sys, cl);
 	}
+      if (switches.json)
+	{
+	  jsonOutClaim (sys, cl);
+	}
+      cacheCaptureEnd (sys, cl);
+      eflush ();
+      timelineEnd ();
       return true;
     }
   return false;
@@ -2767,6 +3024,10 @@ arachne ()
 
   sys->num_regular_runs = 0;
   sys->num_intruder_runs = 0;
+  sys->num_initiator_runs = 0;
+  sys->num_intruder_actions = 0;
+  sys->semitrace_length = 0;
+  sys->regular_steps = 0;
 
   max_encryption_level = 0;
   iterate_role_events (determine_encrypt_max);
@@ -2779,6 +3040,21 @@ arachne ()
 
   fixAgentKeylevels ();
 
+  /*
+   * The initial knowledge does not change anymore, so the node that
+   * represents it can be shared by all claims.
+   */
+  {
+    Termlist m0tl;
+
+    m0tl = knowledgeSet (sys->know);
+    if (m0tl != NULL)
+      {
+	m0term = termlist_to_tuple (m0tl);
+      }
+    termlistDelete (m0tl);
+  }
+
   indentDepth = 0;
   proofDepth = 0;
   cl = sys->claimlist;
@@ -2791,6 +3067,7 @@ arachne ()
       sys->current_claim = cl;
       if (isClaimRelevant (cl))	// check for any filtered claims (switch)
 	{
+	  heuristicProfileSelect ((Protocol) cl->protocol);
 	  if (arachneClaim ())
 	    {
 	      count++;
@@ -2800,6 +3077,8 @@ arachne ()
       // next
       cl = cl->next;
     }
+  termDelete (m0term);
+  m0term = NULL;
   return count;
 }
 
@@ -2874,6 +3153,66 @@ knowledgeAtArachne (const System sys, const int myrun, const int myindex,
   return know;
 }
 
+//! Memoizing wrapper for knowledgeAtArachne()
+/**
+ * While an attack is being rendered the semitrace is frozen, and the same
+ * knowledge sets are requested for many events. In that case the result is
+ * kept, and must not be deleted by the caller; otherwise this is just
+ * knowledgeAtArachne().
+ */
+static Knowledge
+knowledgeAtArachneMemo (const System sys, const int myrun, const int myindex,
+			const int aftercomplete)
+{
+  struct knowmemo *memo;
+  int run, index;
+
+  if (!knowmemo_active)
+    {
+      return knowledgeAtArachne (sys, myrun, myindex, aftercomplete);
+    }
+
+  run = myrun;
+  index = myindex;
+  if (aftercomplete && myindex <= sys->runs[myrun].height)
+    {
+      // Then the event itself does not matter
+      run = -1;
+      index = -1;
+    }
+  for (memo = knowmemo_list; memo != NULL; memo = memo->next)
+    {
+      if (memo->run == run && memo->index == index
+	  && memo->aftercomplete == aftercomplete)
+	{
+	  return memo->know;
+	}
+    }
+  memo = (struct knowmemo *) malloc (sizeof (struct knowmemo));
+  memo->run = run;
+  memo->index = index;
+  memo->aftercomplete = aftercomplete;
+  memo->know = knowledgeAtArachne (sys, myrun, myindex, aftercomplete);
+  memo->next = knowmemo_list;
+  knowmemo_list = memo;
+  return memo->know;
+}
+
+//! Clear the knowledgeAtArachne() memo
+void
+knowledgeMemoFlush (void)
+{
+  while (knowmemo_list != NULL)
+    {
+      struct knowmemo *next;
+
+      next = knowmemo_list->next;
+      knowledgeDelete (knowmemo_list->know);
+      free (knowmemo_list);
+      knowmemo_list = next;
+    }
+}
+
 //! Determine whether a term is trivially known at some event in a partially ordered structure.
 /**
  * Important: read disclaimer at knowledgeAtArachne()
@@ -2888,9 +3227,10 @@ isTriviallyKnownAtArachne (const System sys, const Term t, const int run,
   int result;
   Knowledge knowset;
 
-  knowset = knowledgeAtArachne (sys, run, index, false);
+  knowset = knowledgeAtArachneMemo (sys, run, index, false);
   result = inKnowledge (knowset, t);
-  knowledgeDelete (knowset);
+  if (!knowmemo_active)
+    knowledgeDelete (knowset);
   return result;
 }
 
@@ -2908,9 +3248,10 @@ isTriviallyKnownAfterArachne (const System sys, const Term t, const int run,
   int result;
   Knowledge knowset;
 
-  knowset = knowledgeAtArachne (sys, run, index, true);
+  knowset = knowledgeAtArachneMemo (sys, run, index, true);
   result = inKnowledge (knowset, t);
-  knowledgeDelete (knowset);
+  if (!knowmemo_active)
+    knowledgeDelete (knowset);
   return result;
 }
 
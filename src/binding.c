@@ -23,18 +23,17 @@
 
 #include "list.h"
 #include "role.h"
-#include "label.h"
 #include "system.h"
 #include "binding.h"
 #include "warshall.h"
 #include "debug.h"
 #include "term.h"
-#include "termmap.h"
 #include "arachne.h"
 #include "switches.h"
 #include "depend.h"
 #include "error.h"
 #include "mymalloc.h"
+#include "stats.h"
 
 static System sys;		//!< local storage of system pointer
 
@@ -53,6 +52,7 @@ binding_create (Term term, int run_to, int ev_to)
 {
   Binding b;
 
+  statsMalloc (MEM_BINDINGS, sizeof (struct binding));
   b = malloc (sizeof (struct binding));
   b->done = false;
   b->blocked = false;
@@ -73,6 +73,7 @@ binding_destroy (Binding b)
     {
       goal_unbind (b);
     }
+  statsFree (MEM_BINDINGS, sizeof (struct binding));
   free (b);
 }
 
@@ -88,6 +89,7 @@ bindingInit (const System mysys)
 {
   sys = mysys;
   sys->bindings = NULL;
+  sys->num_bindings_done = 0;
 
   dependInit (sys);
 }
@@ -141,6 +143,7 @@ goal_bind (const Binding b, const int run, const int ev)
     {
       error ("Trying to bind a blocked goal.");
     }
+  stats.goal_binds++;
   if (!b->done)
     {
 #ifdef DEBUG
@@ -163,6 +166,8 @@ goal_bind (const Binding b, const int run, const int ev)
       if (dependPushEvent (run, ev, b->run_to, b->ev_to))
 	{
 	  b->done = true;
+	  sys->num_bindings_done++;
+	  stats.goal_binds_done++;
 	  if (switches.output == PROOF)
 	    {
 	      indentPrint ();
@@ -189,6 +194,7 @@ goal_unbind (const Binding b)
     {
       dependPopEvent ();
       b->done = false;
+      sys->num_bindings_done--;
     }
   else
     {
@@ -262,6 +268,7 @@ goal_add (Term term, const int run, const int ev, const int level)
 	  b = binding_create (term, run, ev);
 	  b->level = level;
 	  sys->bindings = list_insert (sys->bindings, b);
+	  stats.goals_added++;
 #ifdef DEBUG
 	  if (DEBUGL (3))
 	    {
@@ -300,63 +307,6 @@ goal_remove_last (int n)
     }
 }
 
-//! Get index of run
-int
-get_index (const int run, const Term label)
-{
-  Roledef rd;
-  int i;
-
-  i = 0;
-  rd = sys->runs[run].start;
-  while (rd != NULL && !isTermEqual (rd->label, label))
-    {
-      rd = rd->next;
-      i++;
-    }
-#ifdef DEBUG
-  if (rd == NULL)
-    error
-      ("Could not locate send or recv for label, after niagree holds, to test for order.");
-#endif
-  return i;
-}
-
-//! Determine whether some label set is ordered w.r.t. send/recv order.
-/**
- * Assumes all these labels exist in the system, within length etc, and that the run mappings are valid.
- */
-int
-labels_ordered (Termmap runs, Termlist labels)
-{
-  while (labels != NULL)
-    {
-      // Given this label, and the mapping of runs, we want to know if the order is okay. Thus, we need to know sendrole and recvrole
-      Labelinfo linfo;
-      int send_run, send_ev, recv_run, recv_ev;
-      Term label;
-
-      label = labels->term;
-      linfo = label_find (sys->labellist, label);
-      if (!linfo->ignore)
-	{
-	  send_run = termmapGet (runs, linfo->sendrole);
-	  recv_run = termmapGet (runs, linfo->recvrole);
-	  send_ev = get_index (send_run, label);
-	  recv_ev = get_index (recv_run, label);
-	  if (!isDependEvent (send_run, send_ev, recv_run, recv_ev))
-	    {
-	      // Not ordered; false
-	      return false;
-	    }
-
-	}
-      // Proceed
-      labels = labels->next;
-    }
-  return true;
-}
-
 //! Check whether the binding denotes a sensible thing such that we can use run_from and ev_from
 int
 valid_binding (Binding b)
@@ -551,21 +501,30 @@ first_origination ()
       if (valid_binding (b))
 	{
 	  int run;
+	  int target;
+
+	  /*
+	   * All events of a run are tested against the same target node, so
+	   * we resolve the graph nodes once instead of per isDependEvent.
+	   */
+	  target = eventNode (b->run_from, b->ev_from);
 
 	  // Find all preceding events
 	  for (run = 0; run < sys->maxruns; run++)
 	    {
 	      int ev;
+	      int base;
 	      Roledef rd;
 
 	      rd = sys->runs[run].start;
+	      base = eventNode (run, 0);
 
 	      //!@todo hardcoded reference to step, should be length
 	      for (ev = 0; ev < sys->runs[run].step; ev++)
 		{
 		  if (rd->type == SEND || rd->type == RECV)
 		    {
-		      if (isDependEvent (run, ev, b->run_from, b->ev_from))
+		      if (getNode (base + ev, target))
 			{
 			  // this node is *before* the from node
 
@@ -633,23 +592,11 @@ non_redundant ()
 }
 
 //! Count the number of bindings that are done.
+/**
+ * Maintained by goal_bind and goal_unbind. Bindings are never blocked.
+ */
 int
 countBindingsDone ()
 {
-  int count;
-  List bl;
-
-
-  count = 0;
-  for (bl = sys->bindings; bl != NULL; bl = bl->next)
-    {
-      Binding b;
-
-      b = (Binding) bl->data;
-      if ((!b->blocked) && b->done)
-	{
-	  count++;
-	}
-    }
-  return count;
+  return sys->num_bindings_done;
 }
@@ -21,7 +21,6 @@
 #define BINDINGS
 
 #include "term.h"
-#include "termmap.h"
 #include "system.h"
 
 //! Binding structure
@@ -64,7 +63,6 @@ int goal_bind (const Binding b, const int run, const int ev);
 void goal_unbind (const Binding b);
 int binding_block (Binding b);
 int binding_unblock (Binding b);
-int labels_ordered (Termmap runs, Termlist labels);
 
 int iterate_bindings (int (*func) (Binding b));
 int iterate_preceding_bindings (const int run, const int ev,
@@ -0,0 +1,701 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file cache.c
+ * \brief Result cache for claims (--cache)
+ *
+ * The result of a claim is stored on disk, in a file named after a hash of
+ * everything that determines it: the compiled protocols, the claim, the
+ * switches that influence the search or the output, and the version of the
+ * tool. When the same claim is checked again, its counters are restored and
+ * its output is written again, without searching.
+ *
+ * The protocols are hashed after compilation, so the layout of the input
+ * and comments do not matter. Protocols and roles are hashed as sets, so
+ * neither does the order in which they are declared. The events of a role
+ * are hashed in order.
+ *
+ * The output of a claim is everything written through eprintf and the
+ * warnings while the claim is handled, kept as segments for the output
+ * stream and for stderr. It is replayed as is, so the XML output of an
+ * attack shows the command line of the call that found it.
+ *
+ * Results that ran into the time or memory bound are not stored, because
+ * they depend on the machine. Searches that use a random generator shared
+ * by all claims (restarts and --heuristic=-1) and the JSON output, whose
+ * term numbers are shared by all claims, are not cached at all. Neither are
+ * calls with --stats or --report-memory, which report totals of the search
+ * that a replayed claim cannot add to.
+ */
+
+/* mkdir and getpid are not part of C11 */
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef FORWINDOWS
+#include <direct.h>
+#include <process.h>
+#define cache_mkdir(path) _mkdir (path)
+#define cache_getpid() _getpid ()
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#define cache_mkdir(path) mkdir (path, 0777)
+#define cache_getpid() getpid ()
+#endif
+
+#include "cache.h"
+#include "heuristic.h"
+#include "switches.h"
+#include "symbol.h"
+#include "error.h"
+#include "version.h"
+
+//! Version of the file format
+#define CACHE_FORMAT 1
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+extern Protocol INTRUDER;
+extern float heuristic_weight[HEURISTIC_FACTORS];
+
+//! Captured output of a claim, for one stream
+struct segment
+{
+  int tostderr;			//!< True for stderr, otherwise the output stream
+  char *text;			//!< The output
+  size_t length;		//!< Its length
+  size_t size;			//!< Allocated size
+};
+
+int cache_capturing = false;	//!< True while the output is captured
+
+static int cache_enabled = false;	//!< True if --cache is given
+static uint64_t system_hash;	//!< Hash of the compiled protocols
+static char *cache_file = NULL;	//!< File of the claim being captured
+static struct segment *segments = NULL;	//!< Captured output
+static int segmentcount = 0;
+static int segmentsize = 0;
+
+/* counters of the system at the start of the claim */
+static int start_attackid;
+static states_t start_claims;
+static states_t start_states;
+
+//------------------------------------------------------------------------
+// Hashing
+//------------------------------------------------------------------------
+
+//! FNV-1a of some bytes
+static uint64_t
+hashBytes (uint64_t h, const void *data, const size_t n)
+{
+  const unsigned char *p;
+  size_t i;
+
+  p = (const unsigned char *) data;
+  for (i = 0; i < n; i++)
+    {
+      h = (h ^ p[i]) * FNV_PRIME;
+    }
+  return h;
+}
+
+static uint64_t
+hashInt (uint64_t h, const long i)
+{
+  return hashBytes (h, &i, sizeof (i));
+}
+
+//! Hash a string, including its end
+static uint64_t
+hashString (uint64_t h, const char *s)
+{
+  return hashBytes (h, s, strlen (s) + 1);
+}
+
+static int
+hashCompare (const void *a, const void *b)
+{
+  uint64_t x, y;
+
+  x = *((const uint64_t *) a);
+  y = *((const uint64_t *) b);
+  return (x > y) - (x < y);
+}
+
+//! Hash the hashes of the elements of a set, whatever their order
+/**
+ * Sorts the array.
+ */
+static uint64_t
+hashSet (uint64_t h, uint64_t * items, const int n)
+{
+  qsort (items, n, sizeof (uint64_t), hashCompare);
+  h = hashInt (h, n);
+  return hashBytes (h, items, n * sizeof (uint64_t));
+}
+
+//! Hash the names of the types of a leaf
+static uint64_t
+hashTypes (uint64_t h, Termlist tl)
+{
+  uint64_t *items;
+  int n;
+
+  n = termlistLength (tl);
+  items = (uint64_t *) malloc ((n + 1) * sizeof (uint64_t));
+  for (n = 0; tl != NULL; tl = tl->next)
+    {
+      if (realTermLeaf (tl->term) && TermSymb (tl->term) != NULL)
+	{
+	  items[n++] = hashString (FNV_OFFSET, TermSymb (tl->term)->text);
+	}
+    }
+  h = hashSet (h, items, n);
+  free (items);
+  return h;
+}
+
+//! Hash a term
+static uint64_t
+hashTerm (uint64_t h, const Term t)
+{
+  if (t == NULL)
+    {
+      return hashInt (h, -1);
+    }
+  h = hashInt (h, t->type);
+  if (realTermLeaf (t))
+    {
+      if (TermSymb (t) != NULL)
+	{
+	  h = hashString (h, TermSymb (t)->text);
+	}
+      h = hashInt (h, TermRunid (t));
+      return hashTypes (h, (Termlist) t->stype);
+    }
+  if (realTermEncrypt (t))
+    {
+      h = hashInt (h, t->helper.fcall);
+      h = hashTerm (h, TermOp (t));
+      return hashTerm (h, TermKey (t));
+    }
+  h = hashTerm (h, TermOp1 (t));
+  return hashTerm (h, TermOp2 (t));
+}
+
+//! Hash a termlist as a set
+static uint64_t
+hashTermlist (uint64_t h, Termlist tl)
+{
+  uint64_t *items;
+  int n;
+
+  n = termlistLength (tl);
+  items = (uint64_t *) malloc ((n + 1) * sizeof (uint64_t));
+  for (n = 0; tl != NULL; tl = tl->next)
+    {
+      items[n++] = hashTerm (FNV_OFFSET, tl->term);
+    }
+  h = hashSet (h, items, n);
+  free (items);
+  return h;
+}
+
+//! Hash a role, with its events in order
+static uint64_t
+hashRole (const Role r)
+{
+  uint64_t h;
+  Roledef rd;
+
+  h = hashTerm (FNV_OFFSET, r->nameterm);
+  h = hashInt (h, r->initiator);
+  h = hashInt (h, r->singular);
+  for (rd = r->roledef; rd != NULL; rd = rd->next)
+    {
+      h = hashInt (h, rd->type);
+      h = hashInt (h, rd->internal);
+      h = hashTerm (h, rd->label);
+      h = hashTerm (h, rd->from);
+      h = hashTerm (h, rd->to);
+      h = hashTerm (h, rd->message);
+    }
+  h = hashInt (h, -2);
+  h = hashTermlist (h, r->locals);
+  h = hashTermlist (h, r->variables);
+  h = hashTermlist (h, r->declaredconsts);
+  h = hashTermlist (h, r->declaredvars);
+  return hashTermlist (h, r->knows);
+}
+
+//! Hash a protocol, with its roles as a set
+static uint64_t
+hashProtocol (const Protocol p)
+{
+  uint64_t *items;
+  uint64_t h;
+  Role r;
+  int n;
+
+  n = 0;
+  for (r = p->roles; r != NULL; r = r->next)
+    {
+      n++;
+    }
+  items = (uint64_t *) malloc ((n + 1) * sizeof (uint64_t));
+  for (n = 0, r = p->roles; r != NULL; r = r->next)
+    {
+      items[n++] = hashRole (r);
+    }
+  h = hashSet (hashTerm (FNV_OFFSET, p->nameterm), items, n);
+  free (items);
+  return h;
+}
+
+//! Hash the compiled protocols, the agents and the initial knowledge
+static uint64_t
+hashSystem (const System sys)
+{
+  uint64_t *items;
+  uint64_t h;
+  Protocol p;
+  Termlist m0;
+  int n;
+
+  n = 0;
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      n++;
+    }
+  items = (uint64_t *) malloc ((n + 1) * sizeof (uint64_t));
+  n = 0;
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      if (p != INTRUDER)
+	{
+	  items[n++] = hashProtocol (p);
+	}
+    }
+  h = hashSet (FNV_OFFSET, items, n);
+  free (items);
+
+  h = hashTermlist (h, sys->agentnames);
+  h = hashTermlist (h, sys->untrusted);
+  h = hashTermlist (h, sys->globalconstants);
+  m0 = knowledgeSet (sys->know);
+  h = hashTermlist (h, m0);
+  termlistDelete (m0);
+  return h;
+}
+
+//! Hash the switches that influence the search or the output of a claim
+/**
+ * Not included are the time and memory bounds, because results that ran
+ * into them are not stored.
+ */
+static uint64_t
+hashSwitches (uint64_t h)
+{
+  h = hashInt (h, switches.match);
+  h = hashInt (h, switches.tupling);
+  h = hashInt (h, switches.prune);
+  h = hashInt (h, switches.maxproofdepth);
+  h = hashInt (h, switches.maxtracelength);
+  h = hashInt (h, switches.runs);
+  h = hashInt (h, switches.maxAttacks);
+  h = hashBytes (h, &switches.maxStates, sizeof (states_t));
+  h = hashInt (h, switches.maxOfRole);
+  h = hashInt (h, switches.oneRolePerAgent);
+  h = hashInt (h, switches.heuristic);
+  h = hashBytes (h, heuristic_weight, sizeof (heuristic_weight));
+  h = hashInt (h, switches.maxIntruderActions);
+  h = hashInt (h, switches.agentTypecheck);
+  h = hashInt (h, switches.concrete);
+  h = hashInt (h, switches.initUnique);
+  h = hashInt (h, switches.respUnique);
+  h = hashInt (h, switches.roleUnique);
+  h = hashInt (h, switches.intruder);
+  h = hashInt (h, switches.chosenName);
+  h = hashInt (h, switches.agentUnfold);
+  h = hashInt (h, switches.abstractionMethod);
+  h = hashInt (h, switches.useAttackBuffer);
+  h = hashInt (h, switches.switchP);
+  h = hashInt (h, switches.experimental);
+  h = hashInt (h, switches.output);
+  h = hashInt (h, switches.report);
+  h = hashInt (h, switches.reportClaims);
+  h = hashInt (h, switches.xml);
+  h = hashInt (h, switches.dot);
+  h = hashInt (h, switches.human);
+  h = hashInt (h, switches.countStates);
+  h = hashInt (h, switches.profile);
+  h = hashInt (h, switches.extendNonRecvs);
+  h = hashInt (h, switches.extendTrivial);
+  h = hashInt (h, switches.plain);
+  h = hashInt (h, switches.monochrome);
+  h = hashInt (h, switches.lightness);
+  return hashInt (h, switches.clusters);
+}
+
+//! Hash of everything that determines the result of the claim
+static uint64_t
+hashClaim (const System sys, const Claimlist cl)
+{
+  uint64_t h;
+
+  h = hashString (FNV_OFFSET, TAGVERSION);
+  h = hashInt (h, CACHE_FORMAT);
+  h = hashBytes (h, &system_hash, sizeof (system_hash));
+  h = hashSwitches (h);
+  h = hashTerm (h, ((Protocol) cl->protocol)->nameterm);
+  h = hashTerm (h, cl->rolename);
+  h = hashTerm (h, cl->type);
+  h = hashTerm (h, cl->label);
+  h = hashTerm (h, cl->parameter);
+  h = hashInt (h, cl->ev);
+  if (switches.output == ATTACK)
+    {
+      // The attacks in the output are numbered from the start of the run
+      h = hashInt (h, sys->attackid);
+    }
+  return h;
+}
+
+//------------------------------------------------------------------------
+// Files
+//------------------------------------------------------------------------
+
+//! File name for the result of the claim
+/**
+ * The cache directory has a subdirectory for the first two digits of the
+ * hash, which are created if needed. The name has to be freed.
+ */
+static char *
+cacheFileName (const System sys, const Claimlist cl)
+{
+  char hex[17];
+  char *name;
+  size_t len;
+
+  snprintf (hex, sizeof (hex), "%016llx",
+	    (unsigned long long) hashClaim (sys, cl));
+  len = strlen (switches.cache) + 2 * sizeof (hex) + 4;
+  name = (char *) malloc (len);
+  cache_mkdir (switches.cache);
+  snprintf (name, len, "%s/%.2s", switches.cache, hex);
+  cache_mkdir (name);
+  snprintf (name, len, "%s/%.2s/%s", switches.cache, hex, hex + 2);
+  return name;
+}
+
+//! Whether the claim can be cached
+static int
+cacheUsable (void)
+{
+  return (cache_enabled && switches.restarts == 0 && switches.heuristic >= 0
+	  && !switches.json && !switches.reportMemory && !switches.stats);
+}
+
+//! Drop the captured output
+static void
+segmentsClear (void)
+{
+  int i;
+
+  for (i = 0; i < segmentcount; i++)
+    {
+      free (segments[i].text);
+    }
+  segmentcount = 0;
+}
+
+//------------------------------------------------------------------------
+// Interface
+//------------------------------------------------------------------------
+
+//! Set up the cache, after the protocols have been compiled
+void
+cacheInit (const System sys)
+{
+  cache_enabled = (switches.cache != NULL);
+  if (cache_enabled)
+    {
+      system_hash = hashSystem (sys);
+    }
+}
+
+//! Close the cache
+void
+cacheDone (void)
+{
+  segmentsClear ();
+  free (segments);
+  segments = NULL;
+  segmentsize = 0;
+  free (cache_file);
+  cache_file = NULL;
+  cache_capturing = false;
+}
+
+//! Add output to the capture
+/**
+ * Called by the output functions while capturing.
+ */
+void
+cacheCapture (const int tostderr, const char *fmt, va_list args)
+{
+  struct segment *seg;
+  va_list copy;
+  int n;
+
+  if (segmentcount == 0 || segments[segmentcount - 1].tostderr != tostderr)
+    {
+      if (segmentcount == segmentsize)
+	{
+	  segmentsize = (segmentsize == 0 ? 8 : 2 * segmentsize);
+	  segments = (struct segment *)
+	    realloc (segments, segmentsize * sizeof (struct segment));
+	}
+      seg = &segments[segmentcount++];
+      seg->tostderr = tostderr;
+      seg->length = 0;
+      seg->size = 256;
+      seg->text = (char *) malloc (seg->size);
+    }
+  seg = &segments[segmentcount - 1];
+
+  va_copy (copy, args);
+  n = vsnprintf (NULL, 0, fmt, copy);
+  va_end (copy);
+  if (n < 0)
+    {
+      return;
+    }
+  if (seg->length + n + 1 > seg->size)
+    {
+      while (seg->length + n + 1 > seg->size)
+	{
+	  seg->size = 2 * seg->size;
+	}
+      seg->text = (char *) realloc (seg->text, seg->size);
+    }
+  vsnprintf (seg->text + seg->length, n + 1, fmt, args);
+  seg->length += n;
+}
+
+//! Replay the result of the claim, if it is in the cache
+/**
+ * Restores the counters of the claim and the system, and writes the output
+ * again. Returns true if the claim was found.
+ */
+int
+cacheReplay (const System sys, const Claimlist cl)
+{
+  unsigned long count, failed, states, claims, sysstates;
+  int complete, statebound, warnings, attacks;
+  char line[128];
+  char *name;
+  FILE *fp;
+  char *text;
+  int format;
+  int ok;
+
+  if (!cacheUsable ())
+    {
+      return false;
+    }
+  name = cacheFileName (sys, cl);
+  fp = fopen (name, "rb");
+  free (name);
+  if (fp == NULL)
+    {
+      return false;
+    }
+  if (fgets (line, sizeof (line), fp) == NULL
+      || sscanf (line, "scyther-cache %i", &format) != 1
+      || format != CACHE_FORMAT
+      || fgets (line, sizeof (line), fp) == NULL
+      || sscanf (line, "claim %lu %lu %lu %i %i %i", &count, &failed,
+		 &states, &complete, &statebound, &warnings) != 6
+      || fgets (line, sizeof (line), fp) == NULL
+      || sscanf (line, "system %i %lu %lu", &attacks, &claims,
+		 &sysstates) != 3)
+    {
+      fclose (fp);
+      return false;
+    }
+
+  // Read all output first, such that a broken file has no effect
+  segmentsClear ();
+  ok = true;
+  for (;;)
+    {
+      char tag;
+      unsigned long length;
+
+      if (fgets (line, sizeof (line), fp) == NULL
+	  || sscanf (line, "%c %lu", &tag, &length) != 2)
+	{
+	  ok = false;
+	  break;
+	}
+      if (tag == '.')
+	{
+	  break;
+	}
+      text = (char *) malloc (length + 1);
+      if (fread (text, 1, length, fp) != length)
+	{
+	  free (text);
+	  ok = false;
+	  break;
+	}
+      if (segmentcount == segmentsize)
+	{
+	  segmentsize = (segmentsize == 0 ? 8 : 2 * segmentsize);
+	  segments = (struct segment *)
+	    realloc (segments, segmentsize * sizeof (struct segment));
+	}
+      segments[segmentcount].tostderr = (tag == 'e');
+      segments[segmentcount].text = text;
+      segments[segmentcount].length = length;
+      segments[segmentcount].size = length + 1;
+      segmentcount++;
+    }
+  fclose (fp);
+  if (!ok)
+    {
+      segmentsClear ();
+      return false;
+    }
+
+  cl->count = count;
+  cl->failed = failed;
+  cl->states = states;
+  cl->complete = complete;
+  cl->timebound = false;
+  cl->membound = false;
+  cl->statebound = statebound;
+  cl->warnings = warnings;
+  sys->attackid += attacks;
+  sys->claims += claims;
+  sys->states += sysstates;
+  {
+    int i;
+
+    for (i = 0; i < segmentcount; i++)
+      {
+	FILE *stream;
+
+	if (segments[i].tostderr)
+	  {
+	    stream = stderr;
+	  }
+	else
+	  {
+	    stream = (FILE *) globalStream;
+	  }
+	fwrite (segments[i].text, 1, segments[i].length, stream);
+      }
+  }
+  segmentsClear ();
+  return true;
+}
+
+//! Start capturing the output of the claim, if it can be cached
+void
+cacheCaptureStart (const System sys, const Claimlist cl)
+{
+  if (!cacheUsable ())
+    {
+      return;
+    }
+  free (cache_file);
+  cache_file = cacheFileName (sys, cl);
+  start_attackid = sys->attackid;
+  start_claims = sys->claims;
+  start_states = sys->states;
+  segmentsClear ();
+  cache_capturing = true;
+}
+
+//! Store the result of the claim
+/**
+ * Written to a temporary file first, such that other processes never see
+ * half a result.
+ */
+void
+cacheCaptureEnd (const System sys, const Claimlist cl)
+{
+  char *tmpname;
+  size_t len;
+  FILE *fp;
+  int i;
+
+  if (!cache_capturing)
+    {
+      return;
+    }
+  cache_capturing = false;
+  if (cl->timebound || cl->membound)
+    {
+      segmentsClear ();
+      return;
+    }
+
+  len = strlen (cache_file) + 32;
+  tmpname = (char *) malloc (len);
+  snprintf (tmpname, len, "%s.%i", cache_file, (int) cache_getpid ());
+  fp = fopen (tmpname, "wb");
+  if (fp == NULL)
+    {
+      warning ("Could not write to the cache directory %s.", switches.cache);
+      free (tmpname);
+      segmentsClear ();
+      return;
+    }
+  fprintf (fp, "scyther-cache %i\n", CACHE_FORMAT);
+  fprintf (fp, "claim %lu %lu %lu %i %i %i\n", (unsigned long) cl->count,
+	   (unsigned long) cl->failed, (unsigned long) cl->states,
+	   cl->complete, cl->statebound, cl->warnings);
+  fprintf (fp, "system %i %lu %lu\n", sys->attackid - start_attackid,
+	   (unsigned long) (sys->claims - start_claims),
+	   (unsigned long) (sys->states - start_states));
+  for (i = 0; i < segmentcount; i++)
+    {
+      fprintf (fp, "%c %lu\n", (segments[i].tostderr ? 'e' : 'o'),
+	       (unsigned long) segments[i].length);
+      fwrite (segments[i].text, 1, segments[i].length, fp);
+    }
+  fprintf (fp, ". 0\n");
+  if (fclose (fp) != 0 || rename (tmpname, cache_file) != 0)
+    {
+      remove (tmpname);
+    }
+  free (tmpname);
+  segmentsClear ();
+}
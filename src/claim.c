@@ -41,6 +41,7 @@
 #include "timer.h"
 #include "compiler.h"
 #include "depend.h"
+#include "stats.h"
 
 //! When none of the runs match
 #define MATCH_NONE 0
@@ -514,189 +515,226 @@ check_claim_niagree (const System sys, const int i)
   return result;
 }
 
-//! Get label event
-Roledef
-get_label_event (const System sys, const Labelinfo linfo, const Term role,
-		 const Term label, const Termmap runs)
+//! Label of an agreement claim, resolved to roles and role event indices
+struct authlabel
+{
+  int sendrole;			//!< Index of the send role in the claim roles
+  int recvrole;			//!< Index of the recv role in the claim roles
+  int sendev;			//!< Index of the send event in its role
+  int recvev;			//!< Index of the recv event in its role
+};
+
+//! Agreement information of a claim, computed once per claim
+/**
+ * Roles are numbered in the order of claimlist::roles, so the claim role is
+ * 0. Labels are sorted on the highest role index they involve, such that
+ * they can be checked as soon as the runs for both their roles are chosen.
+ */
+static struct
+{
+  Claimlist cl;			//!< Claim this information belongs to
+  int possible;			//!< False iff some label can never be matched
+  int nroles;			//!< Number of roles
+  Term *roles;			//!< Role names
+  int nlabels;			//!< Number of (non-ignored) labels
+  struct authlabel *labels;	//!< Labels, sorted on max(sendrole,recvrole)
+  int *candidates;		//!< Candidate runs, nroles rows of maxruns
+  int *ncandidates;		//!< Number of candidates per role
+  int *chosen;			//!< Chosen run per role
+  int maxruns;			//!< Allocated row size of candidates
+} authinfo;
+
+//! Index of a role name in the claim roles, or -1
+static int
+authinfo_role (const Term role)
 {
-  Roledef rd, rd_res;
   int i;
-  int run;
 
-  run = termmapGet (runs, role);
-  if (run != -1)
+  for (i = 0; i < authinfo.nroles; i++)
     {
-#ifdef DEBUG
-      if (run < 0 || run >= sys->maxruns)
-	{
-	  globalError++;
-	  eprintf ("Run mapping %i out of bounds for role ", run);
-	  termPrint (role);
-	  eprintf (" and label ");
-	  termPrint (label);
-	  eprintf ("\n");
-	  eprintf ("This label has sendrole ");
-	  termPrint (linfo->sendrole);
-	  eprintf (" and recvrole ");
-	  termPrint (linfo->recvrole);
-	  eprintf ("\n");
-	  globalError--;
-	  error ("Run mapping is out of bounds.");
-	}
-#endif
-      rd = sys->runs[run].start;
-      rd_res = NULL;
-      i = 0;
-      while (i < sys->runs[run].step && rd != NULL)
+      if (isTermEqual (authinfo.roles[i], role))
+	return i;
+    }
+  return -1;
+}
+
+//! Index of the first event with a label in a role of the claim protocol, or -1
+static int
+authinfo_event (const Claimlist cl, const Term rolename, const Term label)
+{
+  Role r;
+
+  for (r = ((Protocol) cl->protocol)->roles; r != NULL; r = r->next)
+    {
+      if (isTermEqual (r->nameterm, rolename))
 	{
-	  if (isTermEqual (rd->label, label))
-	    {
-	      rd_res = rd;
-	      rd = NULL;
-	    }
-	  else
+	  Roledef rd;
+	  int i;
+
+	  i = 0;
+	  for (rd = r->roledef; rd != NULL; rd = rd->next)
 	    {
-	      rd = rd->next;
+	      if (isTermEqual (rd->label, label))
+		return i;
+	      i++;
 	    }
-	  i++;
+	  return -1;
 	}
-      return rd_res;
-    }
-  else
-    {
-      return NULL;
     }
+  return -1;
 }
 
-//! Check generic agree claim for a given set of runs, arachne style
-int
-arachne_runs_agree (const System sys, const Claimlist cl, const Termmap runs)
-{
-  Termlist labels;
-  int flag;
+//! Highest role index involved in a label
+#define authlabel_level(al)	((al)->sendrole > (al)->recvrole ? (al)->sendrole : (al)->recvrole)
 
-#ifdef DEBUG
-  if (DEBUGL (5))
+//! Compute the agreement information for a claim
+static void
+authinfo_prepare (const System sys, const Claimlist cl)
+{
+  Termlist tl;
+  int i, j;
+
+  authinfo.cl = cl;
+  authinfo.possible = true;
+  authinfo.maxruns = 0;		// forces reallocation of the candidates
+
+  authinfo.nroles = termlistLength (cl->roles);
+  authinfo.roles =
+    (Term *) realloc (authinfo.roles, authinfo.nroles * sizeof (Term));
+  authinfo.ncandidates =
+    (int *) realloc (authinfo.ncandidates, authinfo.nroles * sizeof (int));
+  authinfo.chosen =
+    (int *) realloc (authinfo.chosen, authinfo.nroles * sizeof (int));
+  i = 0;
+  for (tl = cl->roles; tl != NULL; tl = tl->next)
     {
-      eprintf ("Checking runs agreement for Arachne.\n");
-      termmapPrint (runs);
-      eprintf ("\n");
+      authinfo.roles[i] = tl->term;
+      i++;
     }
-#endif
 
-  flag = 1;
-  labels = cl->prec;
-  while (flag && labels != NULL)
+  authinfo.nlabels = 0;
+  authinfo.labels =
+    (struct authlabel *) realloc (authinfo.labels,
+				  (termlistLength (cl->prec) +
+				   1) * sizeof (struct authlabel));
+  for (tl = cl->prec; tl != NULL; tl = tl->next)
     {
-      // For each label, check whether it matches. Maybe a bit too strict (what about variables?)
-      // Locate roledefs for recv & send, and check whether they are before step
-      Roledef rd_send, rd_recv;
       Labelinfo linfo;
-
-      // Main
-      linfo = label_find (sys->labellist, labels->term);
-      if (!linfo->ignore)
+      struct authlabel al;
+
+      linfo = label_find (sys->labellist, tl->term);
+      if (linfo->ignore)
+	continue;
+      al.sendrole = authinfo_role (linfo->sendrole);
+      al.recvrole = authinfo_role (linfo->recvrole);
+      al.sendev = authinfo_event (cl, linfo->sendrole, tl->term);
+      al.recvev = authinfo_event (cl, linfo->recvrole, tl->term);
+      if (al.sendrole < 0 || al.recvrole < 0 || al.sendev < 0
+	  || al.recvev < 0)
 	{
-	  rd_send =
-	    get_label_event (sys, linfo, linfo->sendrole, labels->term, runs);
-	  rd_recv =
-	    get_label_event (sys, linfo, linfo->recvrole, labels->term, runs);
-
-	  if (rd_send == NULL || rd_recv == NULL)
-	    {
-	      // False!
-	      flag = 0;
-	    }
-	  else
-	    {
-	      // Compare
-	      if (events_match_rd (rd_send, rd_recv) != MATCH_CONTENT)
-		{
-		  // False!
-		  flag = 0;
-		}
-	    }
+	  // Can never be matched by any runs
+	  authinfo.possible = false;
+	  continue;
 	}
-
-      labels = labels->next;
+      // Insertion sort on level; stable, so the claim order is kept
+      j = authinfo.nlabels;
+      while (j > 0
+	     && authlabel_level (&authinfo.labels[j - 1]) >
+	     authlabel_level (&al))
+	{
+	  authinfo.labels[j] = authinfo.labels[j - 1];
+	  j--;
+	}
+      authinfo.labels[j] = al;
+      authinfo.nlabels++;
     }
-  return flag;
 }
 
-// Result structure
-struct flag_and_termmap
+//! Check whether a run has all events needed to play a role in the claim
+static int
+authinfo_viable (const System sys, const int run, const int role)
 {
-  int flag;
-  Termmap termmap;
-};
+  int i;
+  int height;
+
+  height = sys->runs[run].height - sys->runs[run].firstReal;
+  for (i = 0; i < authinfo.nlabels; i++)
+    {
+      const struct authlabel *al = &authinfo.labels[i];
 
-struct flag_and_termmap
-fill_roles (const System sys, const Claimlist cl, const Termmap runs_involved,
-	    const int require_order, Termlist roles_tofill)
+      if ((al->sendrole == role && al->sendev >= height) ||
+	  (al->recvrole == role && al->recvev >= height))
+	{
+	  return false;
+	}
+    }
+  return true;
+}
+
+//! Check a single label for the chosen runs
+static int
+authlabel_holds (const System sys, const struct authlabel *al,
+		 const int require_order)
 {
-  struct flag_and_termmap ftres;
+  int send_run, send_ev, recv_run, recv_ev;
+
+  send_run = authinfo.chosen[al->sendrole];
+  recv_run = authinfo.chosen[al->recvrole];
+  send_ev = sys->runs[send_run].firstReal + al->sendev;
+  recv_ev = sys->runs[recv_run].firstReal + al->recvev;
+  if (events_match_rd (roledef_shift (sys->runs[send_run].start, send_ev),
+		       roledef_shift (sys->runs[recv_run].start,
+				      recv_ev)) != MATCH_CONTENT)
+    {
+      return false;
+    }
+  if (require_order)
+    {
+      // Stronger claim: nisynch. Test for ordering as well.
+      return isDependEvent (send_run, send_ev, recv_run, recv_ev);
+    }
+  return true;
+}
 
-  ftres.flag = true;
-  ftres.termmap = runs_involved;
+//! Choose runs for the roles from some role onwards
+/**
+ * Any labels between the roles chosen so far are checked as soon as
+ * possible, which prunes most assignments early.
+ *
+ *@param label First label that has not been checked yet.
+ *@returns True iff some assignment satisfies all labels.
+ */
+static int
+fill_roles (const System sys, const int role, int label,
+	    const int require_order)
+{
+  int i;
 
-  if (roles_tofill == NULL)
+  // Check labels that involve only chosen roles
+  while (label < authinfo.nlabels
+	 && authlabel_level (&authinfo.labels[label]) < role)
     {
-      // All roles have been chosen
-      if (arachne_runs_agree (sys, cl, runs_involved))
-	{
-	  // niagree holds
-	  if (require_order)
-	    {
-	      // Stronger claim: nisynch. Test for ordering as well.
-	      ftres.flag = labels_ordered (runs_involved, cl->prec);
-	    }
-	  return ftres;
-	}
-      else
+      if (!authlabel_holds (sys, &authinfo.labels[label], require_order))
 	{
-	  // niagree does not hold
-	  ftres.flag = false;
-	  return ftres;
+	  return false;
 	}
+      label++;
     }
-  else
+  if (role == authinfo.nroles)
     {
-      // Choose a run for this role, if possible
-      // Note that any will do
-      int run;
-
-      ftres.flag = false;
-      for (run = 0; run < sys->maxruns; run++)
+      // All roles have been chosen
+      return true;
+    }
+  for (i = 0; i < authinfo.ncandidates[role]; i++)
+    {
+      authinfo.chosen[role] =
+	authinfo.candidates[role * authinfo.maxruns + i];
+      if (fill_roles (sys, role + 1, label, require_order))
 	{
-	  // Has to be from the right protocol
-	  if (sys->runs[run].protocol == cl->protocol)
-	    {
-	      // Has to be the right name
-	      if (isTermEqual
-		  (sys->runs[run].role->nameterm, roles_tofill->term))
-		{
-		  // Choose, iterate
-		  // Mimic lazy evaluation of earlier code
-		  ftres.termmap =
-		    termmapSet (ftres.termmap, roles_tofill->term, run);
-
-		  if (!ftres.flag)
-		    {
-		      struct flag_and_termmap ftres2;
-		      ftres2 =
-			fill_roles (sys, cl, ftres.termmap,
-				    require_order, roles_tofill->next);
-		      if (ftres2.flag)
-			{
-			  ftres.flag = ftres2.flag;
-			  ftres.termmap = ftres2.termmap;
-			}
-		    }
-		}
-	    }
+	  return true;
 	}
     }
-  return ftres;
+  return false;
 }
 
 //! Check arachne authentications claim
@@ -710,8 +748,7 @@ arachne_claim_authentications (const System sys, const int claim_run,
 {
   Claimlist cl;
   Roledef rd;
-  Termmap runs_involved;
-  struct flag_and_termmap ftres;
+  int run;
 
 #ifdef DEBUG
   if (DEBUGL (5))
@@ -727,11 +764,51 @@ arachne_claim_authentications (const System sys, const int claim_run,
 #endif
   cl = rd->claiminfo;
 
-  runs_involved = termmapSet (NULL, cl->roles->term, claim_run);
-  ftres = fill_roles (sys, cl, runs_involved, require_order, cl->roles->next);
+  if (authinfo.cl != cl)
+    {
+      authinfo_prepare (sys, cl);
+    }
+  if (!authinfo.possible)
+    {
+      return false;
+    }
+
+  // Collect the candidate runs for each role
+  if (authinfo.maxruns < sys->maxruns)
+    {
+      authinfo.maxruns = sys->maxruns;
+      authinfo.candidates =
+	(int *) realloc (authinfo.candidates,
+			 authinfo.nroles * authinfo.maxruns * sizeof (int));
+    }
+  for (run = 0; run < authinfo.nroles; run++)
+    {
+      authinfo.ncandidates[run] = 0;
+    }
+  if (!authinfo_viable (sys, claim_run, 0))
+    {
+      return false;
+    }
+  authinfo.chosen[0] = claim_run;
+  for (run = 0; run < sys->maxruns; run++)
+    {
+      // Has to be from the right protocol
+      if (sys->runs[run].protocol == cl->protocol)
+	{
+	  int role;
+
+	  role = authinfo_role (sys->runs[run].role->nameterm);
+	  if (role > 0 && authinfo_viable (sys, run, role))
+	    {
+	      authinfo.candidates[role * authinfo.maxruns +
+				  authinfo.ncandidates[role]] = run;
+	      authinfo.ncandidates[role]++;
+	    }
+	}
+    }
 
-  termmapDelete (ftres.termmap);
-  return ftres.flag;
+  // Role 0 is the claim run itself
+  return fill_roles (sys, 1, 0, require_order);
 }
 
 //! Test niagree
@@ -993,6 +1070,7 @@ prune_claim_specifics (const System sys)
 	  eprintf
 	    ("Pruned because all agents of the claim run must be trusted.\n");
 	}
+      stats.prunes[PRUNE_CLAIM_TRUSTED]++;
       return true;
     }
 
@@ -1009,6 +1087,7 @@ prune_claim_specifics (const System sys)
 	      eprintf
 		("Pruned: niagree holds in this part of the proof tree.\n");
 	    }
+	  stats.prunes[PRUNE_NIAGREE]++;
 	  return 1;
 	}
     }
@@ -1024,6 +1103,7 @@ prune_claim_specifics (const System sys)
 	      eprintf
 		("Pruned: nisynch holds in this part of the proof tree.\n");
 	    }
+	  stats.prunes[PRUNE_NISYNCH]++;
 	  return 1;
 	}
     }
@@ -1039,6 +1119,7 @@ prune_claim_specifics (const System sys)
 	      eprintf
 		("Pruned: Weak agreement holds in this part of the proof tree.\n");
 	    }
+	  stats.prunes[PRUNE_WEAKAGREE]++;
 	  return 1;
 	}
     }
@@ -1054,6 +1135,7 @@ prune_claim_specifics (const System sys)
 	      eprintf
 		("Pruned: alive holds in this part of the proof tree.\n");
 	    }
+	  stats.prunes[PRUNE_ALIVE]++;
 	  return 1;
 	}
     }
@@ -1069,6 +1151,7 @@ prune_claim_specifics (const System sys)
 	      eprintf
 		("Pruned: 'commit => running' holds in this part of the proof tree.\n");
 	    }
+	  stats.prunes[PRUNE_COMMIT]++;
 	  return 1;
 	}
     }
@@ -1238,6 +1321,30 @@ printOkFail (int existState, int isAttack)
     }
 }
 
+//! Print the name of a claim
+/**
+ * As protocol,role and the claim type with the last part of its label,
+ * separated by a tab, for the tab separated reports after a claim.
+ */
+void
+claimNamePrint (const Claimlist cl)
+{
+  Term label;
+
+  termPrint (((Protocol) cl->protocol)->nameterm);
+  eprintf (",");
+  termPrint (cl->rolename);
+  eprintf ("\t");
+  termPrint (cl->type);
+  label = deVar (cl->label);
+  if (realTermTuple (label))
+    {
+      label = TermOp2 (label);
+    }
+  eprintf ("_");
+  termPrint (label);
+}
+
 
 //! Report claim status
 int
@@ -1372,19 +1479,30 @@ claimStatusReport (const System sys, Claimlist cl)
 	}
       else
 	{
+	  int cutshort;
+
 	  /* no state */
-	  printOkFail (false, isAttack);
+	  cutshort = (cl->timebound || cl->membound || cl->statebound);
+	  if (cutshort)
+	    {
+	      /* the search was cut short, so there is no verdict */
+	      eprintf ("%sBounded%s", COLOR_Bold, COLOR_Reset);
+	    }
+	  else
+	    {
+	      printOkFail (false, isAttack);
+	    }
 	  eprintf ("\t");
 
 	  /* subcases */
-	  if (cl->count == 0)
+	  if (cl->count == 0 && !cutshort)
 	    {
 	      /* not encountered */
 	      eprintf ("[does not occur]");
 	    }
 	  else
 	    {
-	      /* does occur */
+	      /* does occur, or might */
 	      if (cl->complete)
 		{
 		  /* complete proof */
@@ -1398,6 +1516,13 @@ claimStatusReport (const System sys, Claimlist cl)
 	    }
 	  if (cl->timebound)
 	    eprintf ("\ttime=%i", get_time_limit ());
+	  if (cl->membound)
+	    eprintf ("\tmemory=%i", get_memory_limit ());
+	  if (cl->statebound)
+	    {
+	      eprintf ("\tmax-states=");
+	      statesFormat (switches.maxStates);
+	    }
 	}
 
       /* states (if asked) */
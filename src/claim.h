@@ -40,6 +40,7 @@ int add_claim_specifics (const System sys, const Claimlist cl, const
 void count_false_claim (const System sys);
 int property_check (const System sys);
 int claimStatusReport (const System sys, Claimlist cl);
+void claimNamePrint (const Claimlist cl);
 int isClaimRelevant (const Claimlist cl);
 int isClaimSignal (const Claimlist cl);
 
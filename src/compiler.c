@@ -38,6 +38,7 @@
 #include "error.h"
 #include "mgu.h"
 #include "type.h"
+#include "timeline.h"
 
 /*
    Simple sys pointer as a global. Yields cleaner code although it's against programming standards.
@@ -159,7 +160,9 @@ compile (Tac tc, int maxrunsset)
   tacProcess (tac_root);
 
   /* Preprocess the result */
+  timelineBegin ("preprocess");
   preprocess (sys);
+  timelineEnd ();
 
   /* cleanup */
   levelDone ();
@@ -612,6 +615,8 @@ claimCreate (const System sys, const Protocol protocol, const Role role,
   cl->count = 0;
   cl->complete = 0;
   cl->timebound = 0;
+  cl->membound = 0;
+  cl->statebound = 0;
   cl->failed = 0;
   cl->states = 0;
   cl->prec = NULL;
@@ -2565,7 +2570,9 @@ preprocess (const System sys)
   /*
    * compute preceding label sets
    */
+  timelineBegin ("compute_prec_sets");
   compute_prec_sets (sys);
+  timelineEnd ();
   /*
    * check whether labels match up
    */
@@ -2589,9 +2596,13 @@ preprocess (const System sys)
    *
    * Needs to be done *after* the initial intruder knowledge derivation.
    */
+  timelineBegin ("hidelevelCompute");
   hidelevelCompute (sys);
+  timelineEnd ();
   /*
    * Check well-formedness
    */
+  timelineBegin ("checkWellFormed");
   checkWellFormed (sys);
+  timelineEnd ();
 }
@@ -29,6 +29,7 @@
 #include "system.h"
 #include "binding.h"
 #include "error.h"
+#include "cost.h"
 #include <limits.h>
 
 //************************************************************************
@@ -59,6 +60,21 @@ computeAttackCost (const System sys)
 
   cost += 10 * selfInitiators (sys);
   cost += 7 * selfResponders (sys);
+  cost += computeAttackCostCounted (sys);
+
+  return cost;
+}
+
+//! The part of computeAttackCost that is kept as counters
+/**
+ * Constant time, unlike the self-session scans.
+ */
+int
+computeAttackCostCounted (const System sys)
+{
+  int cost;
+
+  cost = 0;
   cost += 10 * sys->num_regular_runs;
   cost += 3 * countInitiators (sys);
   cost += 2 * countBindingsDone ();
@@ -98,3 +114,29 @@ attackCost (const System sys)
   error ("Unknown pruning method (cost function not found)");
   return 0;
 }
+
+//! Check whether the attack cost reaches a bound
+/**
+ * Same as (bound <= attackCost (sys)), but avoids scanning for self sessions
+ * when the counted part of the cost already decides it. Each regular run adds
+ * at most 10 for being a self session.
+ */
+int
+attackCostReaches (const System sys, const int bound)
+{
+  if (switches.prune == 2)
+    {
+      int cost;
+
+      cost = computeAttackCostCounted (sys);
+      if (cost >= bound)
+	{
+	  return true;
+	}
+      if (cost + 10 * sys->num_regular_runs < bound)
+	{
+	  return false;
+	}
+    }
+  return (bound <= attackCost (sys));
+}
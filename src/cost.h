@@ -21,6 +21,8 @@
 #define COST
 
 int computeAttackCost (const System sys);
+int computeAttackCostCounted (const System sys);
 int attackCost (const System sys);
+int attackCostReaches (const System sys, const int bound);
 
 #endif
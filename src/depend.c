@@ -32,6 +32,7 @@
 #include "warshall.h"
 #include "debug.h"
 #include "error.h"
+#include "stats.h"
 
 /*
  * Generic structures
@@ -52,6 +53,8 @@ struct depeventgraph
   int rowsize;
   //! Graph structure
   unsigned int *G;
+  //! Allocated size of G (in words)
+  unsigned int capacity;
   //! Zombie dummy push
   int zombie;
   //! Previous graph
@@ -61,6 +64,19 @@ struct depeventgraph
 //! Pointer shorthard
 typedef struct depeventgraph *Depeventgraph;
 
+//! Copy of the top graph, independent of the stack
+struct depsnapshot
+{
+  //! Number of runs
+  int runs;
+  //! Number of nodes
+  int n;
+  //! Rowsize
+  int rowsize;
+  //! Graph structure
+  unsigned int *G;
+};
+
 /*
  * External
  * ---------------------------------------------------------------
@@ -76,6 +92,23 @@ extern Role I_M;		//!< special role; precedes all other events always
 
 Depeventgraph currentdepgraph = NULL;
 
+/*
+ * Graphs are strictly pushed and popped, so we keep the graph structures of
+ * each stack depth around, including their (geometrically grown) matrices.
+ */
+static Depeventgraph *dgpool = NULL;	//!< Graph structures per stack depth
+static int dgpoolsize = 0;	//!< Number of allocated graph structures
+static int dgdepth = 0;		//!< Current stack depth
+
+/*
+ * Node numbering: the events of run r are the nodes nodeoffset[r] up to
+ * nodeoffset[r+1]. Runs are only added and removed at the end, so the
+ * offsets of the runs below the top are the same for all graphs on the
+ * stack.
+ */
+static int *nodeoffset = NULL;	//!< Prefix sums of the role lengths
+static int nodeoffsetsize = 0;	//!< Allocated size of nodeoffset
+
 /*
  * Default code
  * ---------------------------------------------------------------
@@ -86,6 +119,7 @@ void
 dependInit (const System sys)
 {
   currentdepgraph = NULL;
+  dgdepth = 0;
 }
 
 //! Pring
@@ -166,6 +200,22 @@ dependDone (const System sys)
       error
 	("depgraph stack (depend.c) not empty at dependDone, bad iteration?");
     }
+  statsFree (MEM_DEPEND, dgpoolsize * sizeof (Depeventgraph));
+  while (dgpoolsize > 0)
+    {
+      dgpoolsize--;
+      statsFree (MEM_DEPEND,
+		 dgpool[dgpoolsize]->capacity * sizeof (unsigned int) +
+		 sizeof (struct depeventgraph));
+      FREE (dgpool[dgpoolsize]->G);
+      FREE (dgpool[dgpoolsize]);
+    }
+  FREE (dgpool);
+  dgpool = NULL;
+  statsFree (MEM_DEPEND, nodeoffsetsize * sizeof (int));
+  FREE (nodeoffset);
+  nodeoffset = NULL;
+  nodeoffsetsize = 0;
 }
 
 /*
@@ -177,46 +227,45 @@ dependDone (const System sys)
 int
 eventtonode (const Depeventgraph dgx, const int r, const int e)
 {
-  int i;
-  int n;
-
-  n = 0;
-  for (i = 0; i < dgx->sys->maxruns; i++)
+  if (r < 0 || r >= dgx->runs)
     {
-      if (i == r)
-	{
-	  // this run
+      error ("Bad offset (run number too high?) for eventtonode");
+    }
 #ifdef DEBUG
-	  if (dgx->sys->runs[i].rolelength <= e)
-	    {
-	      error ("Bad offset for eventtonode");
-	    }
-#endif
-	  return (n + e);
-	}
-      else
-	{
-	  // not this run, add offset
-	  n += dgx->sys->runs[i].rolelength;
-	}
+  if (dgx->sys->runs[r].rolelength <= e)
+    {
+      error ("Bad offset for eventtonode");
     }
-  error ("Bad offset (run number too high?) for eventtonode");
-  return 0;
+#endif
+  return nodeoffset[r] + e;
 }
 
-//! Return the number of nodes in a graph
-int
-countnodes (const Depeventgraph dgx)
+//! Compute the node offsets of all runs of a (new) graph
+void
+computenodeoffsets (const Depeventgraph dgx)
 {
   int i;
-  int nodes;
 
-  nodes = 0;
-  for (i = 0; i < dgx->sys->maxruns; i++)
+  if (dgx->runs + 1 > nodeoffsetsize)
+    {
+      statsFree (MEM_DEPEND, nodeoffsetsize * sizeof (int));
+      nodeoffsetsize = 2 * (dgx->runs + 1);
+      statsMalloc (MEM_DEPEND, nodeoffsetsize * sizeof (int));
+      nodeoffset =
+	(int *) realloc (nodeoffset, nodeoffsetsize * sizeof (int));
+    }
+  nodeoffset[0] = 0;
+  for (i = 0; i < dgx->runs; i++)
     {
-      nodes += dgx->sys->runs[i].rolelength;
+      nodeoffset[i + 1] = nodeoffset[i] + dgx->sys->runs[i].rolelength;
     }
-  return nodes;
+}
+
+//! Return the number of nodes in a graph
+int
+countnodes (const Depeventgraph dgx)
+{
+  return nodeoffset[dgx->runs];
 }
 
 //! Graph size given the number of nodes
@@ -226,21 +275,72 @@ getGraphSize (const Depeventgraph dgx)
   return (dgx->n * dgx->rowsize);
 }
 
+//! Take the graph structure for the next stack depth
+Depeventgraph
+dependAllocate (const System sys)
+{
+  if (dgdepth == dgpoolsize)
+    {
+      int i;
+
+      statsFree (MEM_DEPEND, dgpoolsize * sizeof (Depeventgraph));
+      dgpoolsize = 2 * dgpoolsize + 8;
+      statsMalloc (MEM_DEPEND, dgpoolsize * sizeof (Depeventgraph));
+      dgpool =
+	(Depeventgraph *) realloc (dgpool,
+				   dgpoolsize * sizeof (Depeventgraph));
+      for (i = dgdepth; i < dgpoolsize; i++)
+	{
+	  statsMalloc (MEM_DEPEND, sizeof (struct depeventgraph));
+	  dgpool[i] = (Depeventgraph) MALLOC (sizeof (struct depeventgraph));
+	  dgpool[i]->G = NULL;
+	  dgpool[i]->capacity = 0;
+	}
+    }
+  sys->depend_graphs++;
+  dgdepth++;
+  return dgpool[dgdepth - 1];
+}
+
+//! Make sure the matrix of a graph can hold getGraphSize() words
+void
+dependReserve (const Depeventgraph dg)
+{
+  unsigned int size;
+
+  size = getGraphSize (dg);
+  if (size > dg->capacity)
+    {
+      statsFree (MEM_DEPEND, dg->capacity * sizeof (unsigned int));
+      dg->capacity = 2 * dg->capacity;
+      if (dg->capacity < size)
+	{
+	  dg->capacity = size;
+	}
+      FREE (dg->G);
+      statsMalloc (MEM_DEPEND, dg->capacity * sizeof (unsigned int));
+      dg->G = (unsigned int *) MALLOC (dg->capacity * sizeof (unsigned int));
+      dg->sys->depend_allocations++;
+    }
+}
+
 //! Create graph from sys
 Depeventgraph
 dependCreate (const System sys)
 {
   Depeventgraph dgnew;
 
-  dgnew = (Depeventgraph) MALLOC (sizeof (struct depeventgraph));
+  dgnew = dependAllocate (sys);
   dgnew->sys = sys;
   dgnew->fornewrun = true;
   dgnew->runs = sys->maxruns;
   dgnew->zombie = 0;
   dgnew->prev = NULL;
-  dgnew->n = countnodes (dgnew);	// count nodes works on ->sys
+  computenodeoffsets (dgnew);	// works on ->sys and ->runs
+  dgnew->n = countnodes (dgnew);
   dgnew->rowsize = WORDSIZE (dgnew->n);
-  dgnew->G = (unsigned int *) CALLOC (1, getGraphSize (dgnew) * sizeof (unsigned int));	// works on ->n and ->rowsize
+  dependReserve (dgnew);	// works on ->n and ->rowsize
+  memset ((void *) dgnew->G, 0, getGraphSize (dgnew) * sizeof (unsigned int));
 
   return dgnew;
 }
@@ -250,19 +350,24 @@ Depeventgraph
 dependCopy (const Depeventgraph dgold)
 {
   Depeventgraph dgnew;
+  unsigned int *G;
+  unsigned int capacity;
 
-  // Copy old to new
-  dgnew = (Depeventgraph) MALLOC (sizeof (struct depeventgraph));
+  // Copy old to new, but keep the matrix of the new depth
+  dgnew = dependAllocate (dgold->sys);
+  G = dgnew->G;
+  capacity = dgnew->capacity;
   memcpy ((void *) dgnew, (void *) dgold,
 	  (size_t) sizeof (struct depeventgraph));
+  dgnew->G = G;
+  dgnew->capacity = capacity;
 
   // New copy
   dgnew->fornewrun = false;
   dgnew->zombie = 0;
 
   // copy inner graph
-  dgnew->G =
-    (unsigned int *) MALLOC (getGraphSize (dgold) * sizeof (unsigned int));
+  dependReserve (dgnew);
   memcpy ((void *) dgnew->G, (void *) dgold->G,
 	  getGraphSize (dgold) * sizeof (unsigned int));
 
@@ -270,11 +375,13 @@ dependCopy (const Depeventgraph dgold)
 }
 
 //! Destroy graph
+/**
+ * Only the top of the stack can be destroyed; its memory is kept for reuse.
+ */
 void
 dependDestroy (const Depeventgraph dgold)
 {
-  FREE (dgold->G);
-  FREE (dgold);
+  dgdepth--;
 }
 
 //! push graph to stack (generic)
@@ -392,7 +499,7 @@ setNode (const int n1, const int n2)
 int
 nodeCount (void)
 {
-  return countnodes (currentdepgraph);
+  return currentdepgraph->n;
 }
 
 /*
@@ -461,6 +568,7 @@ dependPushEvent (const int r1, const int e1, const int r2, const int e2)
   if (isDependEvent (r2, e2, r1, e1))
     {
       // Adding would imply a cycle, so we won't do that.
+      stats.depend_cycles++;
 #ifdef DEBUG
       if (DEBUGL (3))
 	{
@@ -483,6 +591,7 @@ dependPushEvent (const int r1, const int e1, const int r2, const int e2)
 	  // if n->n or the binding already existed, no changes
 	  // no change: add zombie
 	  currentdepgraph->zombie += 1;
+	  stats.depend_zombies++;
 #ifdef DEBUG
 	  debug (5, "Push dependGraph for new event (zombie push)\n");
 	  if (DEBUGL (5))
@@ -504,14 +613,17 @@ dependPushEvent (const int r1, const int e1, const int r2, const int e2)
 	      setDependEvent (r1, e1, r2, e2);
 	      // recompute closure
 	      transitive_closure (currentdepgraph->G, currentdepgraph->n);
+	      stats.closures++;
 	      // check for cycles
 	      if (hasCycle ())
 		{
 		  //warning ("Cycle slipped undetected by the reverse check.");
 		  // Closure introduced cycle, undo it
 		  dependPopEvent ();
+		  stats.depend_cycles++;
 		  return false;
 		}
+	      stats.depend_pushes++;
 #ifdef DEBUG
 	      debug (5, "Push dependGraph for new event (real push)\n");
 	      if (DEBUGL (5))
@@ -590,3 +702,71 @@ iteratePrecedingEvents (const System sys, int (*func) (int run, int ev),
     }
   return true;
 }
+
+//! Copy the current graph
+Depsnapshot
+dependSnapshot (void)
+{
+  Depsnapshot snap;
+  size_t size;
+
+  statsMalloc (MEM_DEPEND, sizeof (struct depsnapshot));
+  snap = (Depsnapshot) MALLOC (sizeof (struct depsnapshot));
+  snap->runs = currentdepgraph->runs;
+  snap->n = currentdepgraph->n;
+  snap->rowsize = currentdepgraph->rowsize;
+  size = getGraphSize (currentdepgraph) * sizeof (unsigned int);
+  statsMalloc (MEM_DEPEND, size);
+  snap->G = (unsigned int *) MALLOC (size);
+  memcpy ((void *) snap->G, (void *) currentdepgraph->G, size);
+  return snap;
+}
+
+//! Push a copied graph
+/**
+ * The runs of sys must be those for which the snapshot was taken, as the
+ * node offsets are recomputed from their role lengths.
+ */
+void
+dependPushSnapshot (const System sys, const Depsnapshot snap)
+{
+  Depeventgraph dgnew;
+
+  dgnew = dependAllocate (sys);
+  dgnew->sys = sys;
+  dgnew->fornewrun = true;
+  dgnew->runs = snap->runs;
+  dgnew->zombie = 0;
+  dgnew->prev = NULL;
+  computenodeoffsets (dgnew);
+  dgnew->n = snap->n;
+  dgnew->rowsize = snap->rowsize;
+  dependReserve (dgnew);
+  memcpy ((void *) dgnew->G, (void *) snap->G,
+	  getGraphSize (dgnew) * sizeof (unsigned int));
+  dependPushGeneric (dgnew);
+}
+
+//! Pop a graph pushed by dependPushSnapshot
+/**
+ * The runs of sys must be the ones of the graph below again.
+ */
+void
+dependPopSnapshot (const System sys)
+{
+  dependPopRun ();
+  if (currentdepgraph != NULL)
+    {
+      computenodeoffsets (currentdepgraph);
+    }
+}
+
+//! Free a snapshot
+void
+dependSnapshotDelete (Depsnapshot snap)
+{
+  statsFree (MEM_DEPEND, snap->n * snap->rowsize * sizeof (unsigned int) +
+	     sizeof (struct depsnapshot));
+  FREE (snap->G);
+  FREE (snap);
+}
@@ -60,4 +60,15 @@ int nodeCount (void);
 int iteratePrecedingEvents (const System sys, int (*func) (int run, int ev),
 			    const int run, const int ev);
 
+/*
+ * Snapshots of the current graph, to be pushed again later on top of a
+ * (restored) semitrace with the same runs.
+ */
+typedef struct depsnapshot *Depsnapshot;
+
+Depsnapshot dependSnapshot (void);
+void dependPushSnapshot (const System sys, const Depsnapshot snap);
+void dependPopSnapshot (const System sys);
+void dependSnapshotDelete (Depsnapshot snap);
+
 #endif
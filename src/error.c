@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include "error.h"
+#include "cache.h"
 
 //! Die from error with exit code
 void
@@ -34,6 +35,14 @@ void
 vprintfstderr (char *fmt, va_list args)
 {
 #ifdef USESTDERR
+  if (cache_capturing)
+    {
+      va_list copy;
+
+      va_copy (copy, args);
+      cacheCapture (true, fmt, copy);
+      va_end (copy);
+    }
   vfprintf (stderr, fmt, args);
 #else
   // no alternative yet
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""
+	Scyther : An automatic verifier for security protocols.
+	Copyright (C) 2007-2025 Cas Cremers
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation; either version 2
+	of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+"""
+
+"""
+Offline tuner for the Arachne goal selection heuristic.
+
+Runs the backend over the bundled protocol corpus with a number of
+--heuristic masks (and optionally --heuristic-weights vectors), records the
+number of states and the time for each claim, and reports the Pareto-best
+settings. It also writes a recommendation file that can be passed back to
+the backend using --heuristic-profile=<FILE>.
+
+Protocol families are the leading letters of the protocol name, which is
+also what the backend matches on (longest prefix wins, '*' is the default).
+
+Example:
+
+    ./heuristic-tune.py --timer=10 --random-weights=8 --output=profile.txt
+"""
+
+import argparse
+import os
+import random
+import re
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+DEFAULT_MASK = 674
+FACTORS = 10
+CORPUS = ["protocols", "testing", os.path.join("gui", "Protocols")]
+
+
+class Setting(object):
+    """ A heuristic mask with an optional weight vector """
+
+    def __init__(self, mask, weights=None):
+        self.mask = mask
+        self.weights = weights
+
+    def args(self):
+        res = ["--heuristic=%i" % self.mask]
+        if self.weights is not None:
+            res.append("--heuristic-weights=%s" % self.weightstring())
+        return res
+
+    def weightstring(self):
+        return ",".join(["%g" % w for w in self.weights])
+
+    def __str__(self):
+        if self.weights is None:
+            return "%i" % self.mask
+        return "%i [%s]" % (self.mask, self.weightstring())
+
+
+class ClaimResult(object):
+    """ Outcome of a single claim for a single setting """
+
+    def __init__(self, fn, protocol, claim, status, states, timebound,
+                 seconds):
+        self.fn = fn
+        self.protocol = protocol
+        self.claim = claim
+        self.status = status
+        self.states = states
+        self.timebound = timebound
+        self.seconds = seconds
+
+    def key(self):
+        return (self.fn, self.protocol, self.claim)
+
+
+def family(protocol):
+    """ Protocol family as used in the recommendation file """
+    mo = re.match("[A-Za-z]+", protocol)
+    if mo is None:
+        return protocol
+    return mo.group(0)
+
+
+def corpus(root):
+    """ All .spdl files in the corpus, relative to root """
+    fl = []
+    for d in CORPUS:
+        for (dirpath, dirnames, filenames) in os.walk(os.path.join(root, d)):
+            for fn in filenames:
+                if fn.endswith(".spdl"):
+                    fl.append(os.path.join(dirpath, fn))
+    return sorted(fl)
+
+
+def settings(opts):
+    """ Candidate settings from the command-line options """
+    if opts.masks:
+        masks = [int(m) for m in opts.masks.split(",")]
+    else:
+        # The default and all single-bit variations of it
+        masks = [DEFAULT_MASK]
+        for bit in range(FACTORS):
+            masks.append(DEFAULT_MASK ^ (1 << bit))
+
+    res = [Setting(m) for m in masks]
+    rng = random.Random(opts.seed)
+    for i in range(opts.random_weights):
+        ws = [round(rng.uniform(0.25, 4), 2) for bit in range(FACTORS)]
+        res.append(Setting(DEFAULT_MASK, ws))
+    return res
+
+
+def evaluate(opts, fn, setting):
+    """ Run the backend on a file and return the per-claim results """
+    args = [opts.scyther, "--plain", "--count-states",
+            "--timer=%i" % opts.timer] + opts.extra + setting.args() + [fn]
+    start = time.time()
+    proc = subprocess.run(args, stdout=subprocess.PIPE,
+                          stderr=subprocess.DEVNULL, universal_newlines=True)
+    seconds = time.time() - start
+
+    res = []
+    for l in proc.stdout.splitlines():
+        data = l.split("\t")
+        if len(data) < 6 or data[0] != "claim":
+            continue
+        protocol = data[1].split(",")[0]
+        states = 0
+        timebound = False
+        for field in data[6:]:
+            if field.startswith("states="):
+                states = int(field[7:])
+            elif (field.startswith("time=") or field.startswith("memory=")
+                  or field.startswith("max-states=")):
+                timebound = True
+        res.append(ClaimResult(fn, protocol, "\t".join(data[1:4]), data[4],
+                               states, timebound, seconds))
+    # Time is measured per file; spread it over its claims.
+    for cr in res:
+        cr.seconds = seconds / len(res)
+    return res
+
+
+def score(results):
+    """ (incomplete claims, states, seconds); lower is better """
+    incomplete = sum([1 for cr in results if cr.timebound])
+    states = sum([cr.states for cr in results])
+    seconds = sum([cr.seconds for cr in results])
+    return (incomplete, states, seconds)
+
+
+def dominates(a, b):
+    return all([x <= y for (x, y) in zip(a, b)]) and a != b
+
+
+def pareto(scores):
+    """ Indices of non-dominated entries """
+    front = []
+    for i in range(len(scores)):
+        if not any([dominates(scores[j], scores[i])
+                    for j in range(len(scores)) if j != i]):
+            front.append(i)
+    return front
+
+
+def verdictchanges(table):
+    """ Claims whose Ok/Fail verdict depends on the setting """
+    verdicts = {}
+    for results in table:
+        for cr in results:
+            if not cr.timebound:
+                verdicts.setdefault(cr.key(), set()).add(cr.status)
+    return [k for k in verdicts if len(verdicts[k]) > 1]
+
+
+def recommend(candidates, table, best):
+    """ Best setting per protocol family, and the default """
+    families = sorted(set([family(cr.protocol) for cr in table[0]]))
+    lines = ["# Generated by heuristic-tune.py",
+             "# <family>\t<heuristic>\t[<weights>]",
+             profileline("*", candidates[best])]
+    for fam in families:
+        scores = []
+        for results in table:
+            sub = [cr for cr in results if family(cr.protocol) == fam]
+            scores.append(score(sub))
+        i = min(range(len(scores)), key=lambda i: scores[i])
+        if scores[i] < scores[best]:
+            lines.append(profileline(fam, candidates[i]))
+    return "\n".join(lines) + "\n"
+
+
+def profileline(fam, setting):
+    if setting.weights is None:
+        return "%s\t%i" % (fam, setting.mask)
+    return "%s\t%i\t%s" % (fam, setting.mask, setting.weightstring())
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--scyther",
+                        default=os.path.join(here, "scyther-linux"),
+                        help="backend binary [%(default)s]")
+    parser.add_argument("--root", default=os.path.dirname(here),
+                        help="repository root with the corpus")
+    parser.add_argument("--masks", default=None,
+                        help="comma-separated list of masks to try")
+    parser.add_argument("--random-weights", type=int, default=0,
+                        help="number of random weight vectors to try")
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--timer", type=int, default=10,
+                        help="time limit per run in seconds [%(default)s]")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--output", default="heuristic-profile.txt",
+                        help="recommendation file [%(default)s]")
+    parser.add_argument("--csv", default=None,
+                        help="also write the per-claim results here")
+    parser.add_argument("extra", nargs="*",
+                        help="additional backend arguments (after --)")
+    opts = parser.parse_args()
+
+    files = corpus(opts.root)
+    candidates = settings(opts)
+    print("Tuning %i settings over %i files" % (len(candidates), len(files)))
+
+    table = []
+    with ThreadPoolExecutor(max_workers=opts.jobs) as pool:
+        for setting in candidates:
+            results = []
+            for res in pool.map(lambda fn: evaluate(opts, fn, setting),
+                                files):
+                results.extend(res)
+            table.append(results)
+            (inc, states, seconds) = score(results)
+            print("%-40s incomplete=%i states=%i time=%.1fs" %
+                  (setting, inc, states, seconds))
+            sys.stdout.flush()
+
+    if opts.csv:
+        fp = open(opts.csv, "w")
+        fp.write("setting\tfile\tclaim\tstatus\tstates\ttimebound\ttime\n")
+        for (setting, results) in zip(candidates, table):
+            for cr in results:
+                fp.write("%s\t%s\t%s\t%s\t%i\t%i\t%.3f\n" %
+                         (setting, cr.fn, cr.claim, cr.status, cr.states,
+                          cr.timebound, cr.seconds))
+        fp.close()
+
+    scores = [score(results) for results in table]
+    front = pareto(scores)
+    print("\nPareto-best settings (incomplete, states, time):")
+    for i in sorted(front, key=lambda i: scores[i]):
+        print("  %-40s %i\t%i\t%.1fs" % ((candidates[i],) + scores[i]))
+
+    changed = verdictchanges(table)
+    if changed:
+        print("\nWarning: %i claims change verdict between settings" %
+              len(changed))
+
+    best = min(front, key=lambda i: scores[i])
+    fp = open(opts.output, "w")
+    fp.write(recommend(candidates, table, best))
+    fp.close()
+    print("\nWrote %s (use --heuristic-profile=%s)" %
+          (opts.output, opts.output))
+
+
+if __name__ == "__main__":
+    main()
@@ -27,6 +27,8 @@
 
 #include <float.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "binding.h"
 #include "system.h"
@@ -36,15 +38,42 @@
 #include "arachne.h"
 #include "error.h"
 #include "knowledge.h"
+#include "heuristic.h"
+#include "restart.h"
 
 #define erode(deltaw) { \
     if (smode & 1) \
       { \
-      	w = w + (deltaw); \
+      	w = w + heuristic_weight[factor] * (deltaw); \
       } \
     smode = smode / 2; \
+    factor++; \
    }
 
+//! Multipliers for the factors selected by the --heuristic mask
+/**
+ * Indexed by bit position. Default 1.0, which leaves the hand-tuned
+ * weights in computeGoalWeight unchanged.
+ */
+float heuristic_weight[HEURISTIC_FACTORS] =
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
+
+//! Settings loaded from a --heuristic-profile file
+struct heuristicprofile
+{
+  char *family;			//!< Protocol name prefix, "*" matches all
+  int heuristic;		//!< Mask to use
+  int hasweights;		//!< Whether the weights field is valid
+  float weight[HEURISTIC_FACTORS];	//!< Factor multipliers
+  struct heuristicprofile *next;
+};
+
+//! Loaded profile entries
+struct heuristicprofile *heuristic_profiles = NULL;
+//! Settings from the command line, restored when no entry matches
+int base_heuristic;
+float base_weight[HEURISTIC_FACTORS];
+
 //! Trivial goal detection
 /**
  * Detect goals that we do not need to solve because they can be trivially solved.
@@ -358,12 +387,14 @@ computeGoalWeight (const System sys, const Binding b)
 {
   float w;
   int smode;
+  int factor;
   Term t;
 
   // Total weight
   w = 0;
   // We will shift this mode variable
   smode = switches.heuristic;
+  factor = 0;
   t = b->term;
 
   // Determine buf_constrain levels
@@ -414,6 +445,7 @@ select_goal_masked (const System sys)
   List bl;
   Binding best;
   float best_weight;
+  int ties;
 
   // Find the most constrained goal
   if (switches.output == PROOF)
@@ -423,6 +455,7 @@ select_goal_masked (const System sys)
     }
   best_weight = FLT_MAX;
   best = NULL;
+  ties = 0;
   bl = sys->bindings;
   while (bl != NULL)
     {
@@ -434,6 +467,7 @@ select_goal_masked (const System sys)
       if (is_goal_selectable (sys, b))
 	{
 	  float w;
+	  int take;
 
 	  w = computeGoalWeight (sys, b);
 
@@ -441,8 +475,20 @@ select_goal_masked (const System sys)
 	  if (switches.output == PROOF && best != NULL)
 	    eprintf (", ");
 
-	  // Better alternative?
-	  if (w <= best_weight)
+	  // Better alternative? For equal weights, we normally take the
+	  // later one; during a randomized restart, a uniformly random one.
+	  take = false;
+	  if (w < best_weight)
+	    {
+	      ties = 1;
+	      take = true;
+	    }
+	  else if (w == best_weight)
+	    {
+	      ties++;
+	      take = (!restart_randomize || restartRandom (ties) == 0);
+	    }
+	  if (take)
 	    {
 	      best_weight = w;
 	      best = b;
@@ -524,3 +570,181 @@ select_goal (const System sys)
     }
   return (Binding) NULL;
 }
+
+//! Parse a comma-separated list of factor weights
+/**
+ * Missing trailing entries keep their current value. Returns the number of
+ * weights parsed.
+ */
+int
+heuristicParseWeights (float *weight, const char *spec)
+{
+  int i;
+  const char *p;
+
+  i = 0;
+  p = spec;
+  while (p != NULL && *p != '\0' && i < HEURISTIC_FACTORS)
+    {
+      char *end;
+      float f;
+
+      f = strtof (p, &end);
+      if (end == p)
+	{
+	  error ("Could not parse heuristic weight list \"%s\".", spec);
+	}
+      weight[i] = f;
+      i++;
+      p = end;
+      if (*p == ',')
+	{
+	  p++;
+	}
+      else if (*p != '\0')
+	{
+	  error ("Could not parse heuristic weight list \"%s\".", spec);
+	}
+    }
+  return i;
+}
+
+//! Set the factor weights from a --heuristic-weights argument
+void
+heuristicSetWeights (const char *spec)
+{
+  heuristicParseWeights (heuristic_weight, spec);
+}
+
+//! Load a recommendation file as written by heuristic-tune.py
+/**
+ * Each non-empty line not starting with '#' reads
+ *
+ *	<family> <heuristic> [<w0>,<w1>,...]
+ *
+ * where <family> is a protocol name prefix, or '*' for any protocol.
+ * The current switches are kept as the fallback for unmatched protocols.
+ */
+void
+heuristicProfileLoad (const char *filename)
+{
+  FILE *fp;
+  char line[1024];
+  int lineno;
+
+  fp = fopen (filename, "r");
+  if (fp == NULL)
+    {
+      error ("Could not open heuristic profile '%s'.", filename);
+    }
+  base_heuristic = switches.heuristic;
+  memcpy (base_weight, heuristic_weight, sizeof (base_weight));
+
+  lineno = 0;
+  while (fgets (line, sizeof (line), fp) != NULL)
+    {
+      char family[256];
+      char weights[768];
+      int heuristic;
+      int n;
+
+      lineno++;
+      n = sscanf (line, " %255s %i %767s", family, &heuristic, weights);
+      if (n <= 0 || family[0] == '#')
+	{
+	  continue;
+	}
+      if (n < 2)
+	{
+	  error ("Heuristic profile '%s', line %i: expected a heuristic.",
+		 filename, lineno);
+	}
+      else
+	{
+	  struct heuristicprofile *hp;
+
+	  hp = (struct heuristicprofile *) malloc (sizeof (*hp));
+	  hp->family = (char *) malloc (strlen (family) + 1);
+	  strcpy (hp->family, family);
+	  hp->heuristic = heuristic;
+	  memcpy (hp->weight, base_weight, sizeof (hp->weight));
+	  hp->hasweights = (n > 2);
+	  if (hp->hasweights)
+	    {
+	      heuristicParseWeights (hp->weight, weights);
+	    }
+	  hp->next = heuristic_profiles;
+	  heuristic_profiles = hp;
+	}
+    }
+  fclose (fp);
+}
+
+//! Select the profile entry for a protocol
+/**
+ * Picks the entry with the longest family prefix of the protocol name, and
+ * otherwise restores the command-line settings.
+ */
+void
+heuristicProfileSelect (const Protocol p)
+{
+  struct heuristicprofile *hp;
+  struct heuristicprofile *best;
+  size_t bestlen;
+  const char *name;
+
+  if (heuristic_profiles == NULL)
+    {
+      return;
+    }
+  name = TermSymb (p->nameterm)->text;
+  best = NULL;
+  bestlen = 0;
+  for (hp = heuristic_profiles; hp != NULL; hp = hp->next)
+    {
+      size_t len;
+
+      if (strcmp (hp->family, "*") == 0)
+	{
+	  len = 0;
+	}
+      else
+	{
+	  len = strlen (hp->family);
+	  if (strncmp (hp->family, name, len) != 0)
+	    {
+	      continue;
+	    }
+	}
+      if (best == NULL || len > bestlen)
+	{
+	  best = hp;
+	  bestlen = len;
+	}
+    }
+  if (best == NULL)
+    {
+      switches.heuristic = base_heuristic;
+      memcpy (heuristic_weight, base_weight, sizeof (base_weight));
+    }
+  else
+    {
+      switches.heuristic = best->heuristic;
+      memcpy (heuristic_weight, best->weight, sizeof (best->weight));
+    }
+}
+
+//! Clean up profile entries
+void
+heuristicProfileDone (void)
+{
+  while (heuristic_profiles != NULL)
+    {
+      struct heuristicprofile *hp;
+
+      hp = heuristic_profiles;
+      heuristic_profiles = hp->next;
+      free (hp->family);
+      free (hp);
+    }
+}
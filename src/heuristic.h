@@ -23,6 +23,13 @@
 #include "system.h"
 #include "binding.h"
 
+//! Number of factors that can be selected by the --heuristic mask
+#define HEURISTIC_FACTORS 10
+
 Binding select_goal (const System sys);
+void heuristicSetWeights (const char *spec);
+void heuristicProfileLoad (const char *filename);
+void heuristicProfileSelect (const Protocol p);
+void heuristicProfileDone (void);
 
 #endif
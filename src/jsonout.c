@@ -0,0 +1,654 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * jsonout.c
+ *
+ * JSON lines output for Scyther
+ *
+ * A compact alternative to the XML output, for programs that only need the
+ * claim verdicts and sometimes the attack patterns. Every line is a single
+ * JSON object, identified by its first key:
+ *
+ *   {"term":7,"const":"ni","run":1}		a term definition
+ *   {"attack":3,...}				an attack pattern
+ *   {"claim":12,...}				the result for a claim
+ *   {"totals":{...}}				counters for the whole run, last
+ *
+ * With --stats, the totals also hold the counters of the search.
+ *
+ * Terms are only defined once, on the first line before a record that uses
+ * them, and are referred to by their number everywhere else. Equal terms get
+ * the same number, also across claims. Terms are defined as one of
+ *
+ *   "const":name,"run":r    "var":name,"run":r    (r is -1 for globals)
+ *   "enc":[op,key]    "apply":[function,arg]    "tuple":[op1,op2]
+ *
+ * An attack record lists its runs, with the events shown as
+ * [type,label,from,to,message] (for claims: [type,label,role,claim,argument]),
+ * and its bindings as [fromrun,fromindex,torun,toindex,term], where fromrun
+ * and fromindex are -1 if the binding is not done. A claim record lists the
+ * identifiers of the attacks that were output for it.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+#include "term.h"
+#include "termlist.h"
+#include "system.h"
+#include "binding.h"
+#include "arachne.h"		// for get_semitrace_length
+#include "switches.h"
+#include "specialterm.h"
+#include "claim.h"
+#include "xmlout.h"		// for showthis
+#include "timer.h"
+#include "stats.h"
+
+#include "jsonout.h"
+
+/*
+ * Externally defined
+ */
+extern Protocol INTRUDER;	// from arachne.c
+
+//! Kinds of term definitions
+enum jsonkinds
+{ JSON_CONST, JSON_VAR, JSON_ENC, JSON_APPLY, JSON_TUPLE };
+
+//! Entry of the term table
+struct jsonterm
+{
+  int kind;			//!< From enum jsonkinds
+  intptr_t a;			//!< Symbol for leaves, otherwise left subterm number
+  int b;			//!< Run for leaves, otherwise right subterm number
+  int id;			//!< Term number, 0 for a free slot
+};
+
+/*
+ * Global/static stuff.
+ */
+static struct jsonterm *jsonterms;	// term table (open addressing)
+static int jsontermsize;	// number of slots in the table
+static int jsontermcount;	// number of terms defined so far
+static int json_declaring;	// if true, only define terms, print nothing else
+static int *json_attacks;	// attacks output for the current claim
+static int json_attackcount;	// number of those
+static int json_attacksize;	// allocated size of json_attacks
+
+/*
+ * Default external interface: init/done
+ */
+
+//! Init this module
+void
+jsonOutInit (void)
+{
+  jsonterms = NULL;
+  jsontermsize = 0;
+  jsontermcount = 0;
+  json_declaring = false;
+  json_attacks = NULL;
+  json_attackcount = 0;
+  json_attacksize = 0;
+}
+
+//! Close up
+void
+jsonOutDone (void)
+{
+  free (jsonterms);
+  jsonterms = NULL;
+  free (json_attacks);
+  json_attacks = NULL;
+}
+
+/*
+ * Local code, needed for any further real code.
+ */
+
+//! JSON print
+/**
+ * Input is comparable to eprintf, but nothing is printed while the terms of
+ * a record are being defined.
+ */
+void
+jsonPrint (char *fmt, ...)
+{
+  va_list args;
+
+  if (!json_declaring)
+    {
+      va_start (args, fmt);
+      veprintf (fmt, args);
+      va_end (args);
+    }
+}
+
+//! Print a string, escaped
+void
+jsonEscape (const char *s)
+{
+  eprintf ("\"");
+  while (*s != '\0')
+    {
+      if (*s == '"' || *s == '\\')
+	{
+	  eprintf ("\\%c", *s);
+	}
+      else if ((unsigned char) *s < 0x20)
+	{
+	  eprintf ("\\u%04x", (unsigned char) *s);
+	}
+      else
+	{
+	  eprintf ("%c", *s);
+	}
+      s++;
+    }
+  eprintf ("\"");
+}
+
+//! Print a string value
+void
+jsonString (const char *s)
+{
+  if (!json_declaring)
+    {
+      jsonEscape (s);
+    }
+}
+
+//! Print a boolean value
+void
+jsonBool (const int value)
+{
+  jsonPrint (value ? "true" : "false");
+}
+
+//! Slot of a key in the term table
+int
+jsonSlot (const int kind, const intptr_t a, const int b)
+{
+  uintptr_t h;
+  int i;
+
+  h = ((uintptr_t) a * 31 + (uintptr_t) b) * 2654435761u + kind;
+  i = (int) (h & (jsontermsize - 1));
+  while (jsonterms[i].id != 0)
+    {
+      if (jsonterms[i].kind == kind && jsonterms[i].a == a
+	  && jsonterms[i].b == b)
+	{
+	  break;
+	}
+      i = (i + 1) & (jsontermsize - 1);
+    }
+  return i;
+}
+
+//! Make room for another term
+void
+jsonGrow (void)
+{
+  struct jsonterm *old;
+  int oldsize;
+  int i;
+
+  old = jsonterms;
+  oldsize = jsontermsize;
+  jsontermsize = (oldsize == 0 ? 1024 : 2 * oldsize);
+  jsonterms =
+    (struct jsonterm *) calloc (jsontermsize, sizeof (struct jsonterm));
+  for (i = 0; i < oldsize; i++)
+    {
+      if (old[i].id != 0)
+	{
+	  jsonterms[jsonSlot (old[i].kind, old[i].a, old[i].b)] = old[i];
+	}
+    }
+  free (old);
+}
+
+//! Look up a term in the table, defining it if it is new
+/**
+ * If the second argument is true, a leaf is taken as is, otherwise its
+ * substitution is followed first.
+ */
+int
+jsonTermNumber (Term term, const int asis)
+{
+  int kind;
+  intptr_t a;
+  int b;
+  int i;
+
+  if (!asis)
+    {
+      term = deVar (term);
+    }
+  if (realTermLeaf (term))
+    {
+      kind = (realTermVariable (term) ? JSON_VAR : JSON_CONST);
+      a = (intptr_t) TermSymb (term);
+      b = TermRunid (term);
+    }
+  else if (realTermEncrypt (term))
+    {
+      if (isTermLeaf (TermKey (term))
+	  && inTermlist (TermKey (term)->stype, TERM_Function))
+	{
+	  kind = JSON_APPLY;
+	}
+      else
+	{
+	  kind = JSON_ENC;
+	}
+      a = jsonTermNumber (TermOp (term), false);
+      b = jsonTermNumber (TermKey (term), false);
+    }
+  else
+    {
+      kind = JSON_TUPLE;
+      a = jsonTermNumber (TermOp1 (term), false);
+      b = jsonTermNumber (TermOp2 (term), false);
+    }
+
+  if (2 * (jsontermcount + 1) > jsontermsize)
+    {
+      jsonGrow ();
+    }
+  i = jsonSlot (kind, a, b);
+  if (jsonterms[i].id == 0)
+    {
+      // New term: define it
+      jsontermcount++;
+      jsonterms[i].kind = kind;
+      jsonterms[i].a = a;
+      jsonterms[i].b = b;
+      jsonterms[i].id = jsontermcount;
+
+      eprintf ("{\"term\":%i,", jsontermcount);
+      switch (kind)
+	{
+	case JSON_CONST:
+	case JSON_VAR:
+	  eprintf (kind == JSON_VAR ? "\"var\":" : "\"const\":");
+	  jsonEscape (TermSymb (term)->text);
+	  eprintf (",\"run\":%i}\n", (b >= 0 ? b : -1));
+	  break;
+	case JSON_ENC:
+	  eprintf ("\"enc\":[%i,%i]}\n", (int) a, b);
+	  break;
+	case JSON_APPLY:
+	  eprintf ("\"apply\":[%i,%i]}\n", b, (int) a);
+	  break;
+	default:
+	  eprintf ("\"tuple\":[%i,%i]}\n", (int) a, b);
+	  break;
+	}
+    }
+  return jsonterms[i].id;
+}
+
+//! Print the number of a term, or null
+void
+jsonTerm (const Term term)
+{
+  if (term == NULL)
+    {
+      jsonPrint ("null");
+    }
+  else
+    {
+      int id;
+
+      id = jsonTermNumber (term, false);
+      jsonPrint ("%i", id);
+    }
+}
+
+//! Print the number of a variable itself, without its substitution
+void
+jsonVariable (const Term term)
+{
+  jsonPrint ("%i", jsonTermNumber (term, true));
+}
+
+//! Name of a protocol or role term
+void
+jsonName (const Term term)
+{
+  jsonString (TermSymb (term)->text);
+}
+
+//! Output a record
+/**
+ * The record is generated twice: first to define any new terms it uses, and
+ * then to print it.
+ */
+void
+jsonRecord (const System sys, void (*record) (const System sys, void *data),
+	    void *data)
+{
+  json_declaring = true;
+  record (sys, data);
+  json_declaring = false;
+  record (sys, data);
+  jsonPrint ("\n");
+}
+
+//! Type of an event
+void
+jsonEventType (const Roledef rd)
+{
+  switch (rd->type)
+    {
+    case RECV:
+      jsonPrint ("\"recv\"");
+      break;
+    case SEND:
+      jsonPrint ("\"send\"");
+      break;
+    case CLAIM:
+      jsonPrint ("\"claim\"");
+      break;
+    default:
+      jsonPrint ("\"unknown\"");
+      break;
+    }
+}
+
+//! A single run of a semitrace
+void
+jsonRun (const System sys, const int run)
+{
+  Termlist tl;
+  Roledef rd;
+  int index;
+
+  jsonPrint ("{\"run\":%i,\"protocol\":", run);
+  jsonName (sys->runs[run].protocol->nameterm);
+  jsonPrint (",\"role\":");
+  jsonName (sys->runs[run].role->nameterm);
+  jsonPrint (",\"intruder\":");
+  jsonBool (sys->runs[run].protocol == INTRUDER);
+  jsonPrint (",\"trusted\":");
+  jsonBool (isRunTrusted (sys, run));
+
+  jsonPrint (",\"agents\":[");
+  for (tl = sys->runs[run].protocol->rolenames; tl != NULL; tl = tl->next)
+    {
+      jsonTerm (agentOfRunRole (sys, run, tl->term));
+      if (tl->next != NULL)
+	{
+	  jsonPrint (",");
+	}
+    }
+
+  jsonPrint ("],\"vars\":[");
+  index = 0;
+  for (tl = sys->runs[run].sigma; tl != NULL; tl = tl->next)
+    {
+      if (realTermVariable (tl->term))
+	{
+	  jsonPrint ("%s[", (index > 0 ? "," : ""));
+	  jsonVariable (tl->term);
+	  jsonPrint (",");
+	  jsonTerm (tl->term->subst);
+	  jsonPrint ("]");
+	  index++;
+	}
+    }
+
+  jsonPrint ("],\"events\":[");
+  index = 0;
+  rd = sys->runs[run].start;
+  while (showthis (sys, run, rd, index))
+    {
+      jsonPrint ("%s[", (index > 0 ? "," : ""));
+      jsonEventType (rd);
+      jsonPrint (",");
+      jsonTerm (rd->label);
+      jsonPrint (",");
+      jsonTerm (rd->from);
+      jsonPrint (",");
+      jsonTerm (rd->to);
+      jsonPrint (",");
+      jsonTerm (rd->message);
+      jsonPrint ("]");
+      index++;
+      rd = rd->next;
+    }
+  jsonPrint ("]}");
+}
+
+//! Record for a semitrace
+void
+jsonSemitraceRecord (const System sys, void *data)
+{
+  List bl;
+  int run;
+
+  jsonPrint ("{\"attack\":%i,\"claim\":", sys->attackid);
+  jsonTerm (sys->current_claim->type);
+  jsonPrint (",\"label\":");
+  jsonTerm (sys->current_claim->label);
+  jsonPrint (",\"tracelength\":%i", get_semitrace_length ());
+
+  jsonPrint (",\"runs\":[");
+  for (run = 0; run < sys->maxruns; run++)
+    {
+      if (run > 0)
+	{
+	  jsonPrint (",");
+	}
+      jsonRun (sys, run);
+    }
+
+  jsonPrint ("],\"bindings\":[");
+  for (bl = sys->bindings; bl != NULL; bl = bl->next)
+    {
+      Binding b;
+
+      b = (Binding) bl->data;
+      if (b->done)
+	{
+	  jsonPrint ("[%i,%i,", b->run_from, b->ev_from);
+	}
+      else
+	{
+	  jsonPrint ("[-1,-1,");
+	}
+      jsonPrint ("%i,%i,", b->run_to, b->ev_to);
+      jsonTerm (b->term);
+      jsonPrint ("]%s", (bl->next != NULL ? "," : ""));
+    }
+  jsonPrint ("]}");
+}
+
+//! Record for a claim
+void
+jsonClaimRecord (const System sys, void *data)
+{
+  Claimlist cl;
+  int i;
+
+  cl = (Claimlist) data;
+  jsonPrint ("{\"claim\":");
+  jsonTerm (cl->type);
+  jsonPrint (",\"label\":");
+  jsonTerm (cl->label);
+  jsonPrint (",\"protocol\":");
+  jsonName (((Protocol) cl->protocol)->nameterm);
+  jsonPrint (",\"role\":");
+  jsonName (cl->rolename);
+  jsonPrint (",\"parameter\":");
+  jsonTerm (cl->parameter);
+
+  if (!isTermEqual (cl->type, CLAIM_Empty))
+    {
+      jsonPrint (",\"failed\":%lu,\"count\":%lu,\"states\":%lu",
+		 cl->failed, cl->count, cl->states);
+      jsonPrint (",\"complete\":");
+      jsonBool (cl->complete);
+      jsonPrint (",\"timebound\":");
+      jsonBool (cl->timebound);
+      jsonPrint (",\"membound\":");
+      jsonBool (cl->membound);
+      if (cl->statebound)
+	{
+	  jsonPrint (",\"statebound\":%lu", switches.maxStates);
+	}
+    }
+
+  jsonPrint (",\"attacks\":[");
+  for (i = 0; i < json_attackcount; i++)
+    {
+      jsonPrint ("%s%i", (i > 0 ? "," : ""), json_attacks[i]);
+    }
+  jsonPrint ("]}");
+}
+
+//! Runs created for the roles of a protocol, as "protocol,role":n pairs
+void
+jsonRoleRuns (const Protocol p, int *first)
+{
+  Role r;
+
+  for (r = p->roles; r != NULL; r = r->next)
+    {
+      if (r->created > 0)
+	{
+	  jsonPrint ("%s\"%s,%s\":%lu", (*first ? "" : ","),
+		     TermSymb (p->nameterm)->text,
+		     TermSymb (r->nameterm)->text, r->created);
+	  *first = false;
+	}
+    }
+}
+
+//! Counters of the search (--stats)
+void
+jsonStatistics (const System sys)
+{
+  Protocol p;
+  int rule;
+  int first;
+
+  jsonPrint (",\"unify\":%lu,\"unifiers\":%lu", stats.unify,
+	     stats.unifiers);
+  jsonPrint (",\"subtermunify\":%lu,\"subtermunifiers\":%lu",
+	     stats.subterm_unify, stats.subterm_unifiers);
+  jsonPrint (",\"dependpushes\":%lu,\"dependzombies\":%lu",
+	     stats.depend_pushes, stats.depend_zombies);
+  jsonPrint (",\"dependcycles\":%lu,\"closures\":%lu",
+	     stats.depend_cycles, stats.closures);
+  jsonPrint (",\"goalsadded\":%lu,\"goalbinds\":%lu,\"goalbindsdone\":%lu",
+	     stats.goals_added, stats.goal_binds, stats.goal_binds_done);
+  jsonPrint (",\"prunes\":{");
+  first = true;
+  for (rule = 0; rule < PRUNE_RULES; rule++)
+    {
+      if (stats.prunes[rule] > 0)
+	{
+	  jsonPrint ("%s\"%s\":%lu", (first ? "" : ","),
+		     statsPruneName (rule), stats.prunes[rule]);
+	  first = false;
+	}
+    }
+  jsonPrint ("},\"runs\":{");
+  first = true;
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      jsonRoleRuns (p, &first);
+    }
+  jsonRoleRuns (INTRUDER, &first);
+  jsonPrint ("}");
+}
+
+//! Record with the totals of the system
+void
+jsonTotalsRecord (const System sys, void *data)
+{
+  long maxrss;
+
+  jsonPrint ("{\"totals\":{\"states\":%lu,\"claims\":%lu",
+	     sys->states, sys->claims);
+  jsonPrint (",\"runchanges\":%lu,\"runallocations\":%lu",
+	     sys->run_changes, sys->run_allocations);
+  jsonPrint (",\"dependgraphs\":%lu,\"dependallocations\":%lu",
+	     sys->depend_graphs, sys->depend_allocations);
+  jsonPrint (",\"terms\":%lu,\"termlists\":%lu",
+	     stats.memory[MEM_TERMS].allocations,
+	     stats.memory[MEM_TERMLISTS].allocations);
+  if (switches.stats)
+    {
+      jsonStatistics (sys);
+    }
+  maxrss = peak_memory_kilobytes ();
+  if (maxrss >= 0)
+    {
+      jsonPrint (",\"maxrss\":%ld", maxrss);
+    }
+  jsonPrint ("}}");
+}
+
+/*
+ * -----------------------------------------------------------------------------------
+ * Publicly available functions
+ */
+
+//! Output for a semitrace (from arachne method)
+void
+jsonOutSemitrace (const System sys)
+{
+  if (json_attackcount == json_attacksize)
+    {
+      json_attacksize = 2 * json_attacksize + 4;
+      json_attacks =
+	(int *) realloc (json_attacks, json_attacksize * sizeof (int));
+    }
+  json_attacks[json_attackcount] = sys->attackid;
+  json_attackcount++;
+
+  jsonRecord (sys, jsonSemitraceRecord, NULL);
+}
+
+//! Output for a claim
+/**
+ * Lists the attacks that were output since the previous claim.
+ */
+void
+jsonOutClaim (const System sys, Claimlist cl)
+{
+  jsonRecord (sys, jsonClaimRecord, (void *) cl);
+  json_attackcount = 0;
+}
+
+//! Output the totals, after all claims
+void
+jsonOutTotals (const System sys)
+{
+  jsonRecord (sys, jsonTotalsRecord, NULL);
+  eflush ();
+}
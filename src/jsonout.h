@@ -0,0 +1,33 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef JSONOUT
+#define JSONOUT
+
+#include "system.h"
+#include "claim.h"
+
+void jsonOutInit (void);
+void jsonOutDone (void);
+
+void jsonOutSemitrace (const System sys);
+void jsonOutClaim (const System sys, Claimlist cl);
+void jsonOutTotals (const System sys);
+
+#endif
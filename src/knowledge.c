@@ -31,6 +31,310 @@
 #include "debug.h"
 #include "error.h"
 #include "specialterm.h"
+#include "stats.h"
+
+/*
+ * Hash index
+ *
+ * The termlists in the knowledge structure determine the order in which
+ * terms are reported (e.g. for the initial intruder knowledge), so they are
+ * kept as they are. Next to them we maintain two hash indices: one on the
+ * terms themselves, for membership tests, and one on the keys of the
+ * encrypted terms, so that adding a key only decrypts what it unlocks.
+ *
+ * Only terms that do not contain open variables are indexed, because their
+ * structure (and thus their hash) does not change while the knowledge is in
+ * use. Substitutions that were made before a term was added are assumed to
+ * stay in place for the lifetime of the knowledge set. The remaining terms
+ * are kept on the knowledge::loose lists and scanned as before.
+ */
+
+//! Initial number of buckets of a knowledge hash index
+#define KNOWHASH_INITIAL 16
+
+//! Node of a knowledge hash index
+struct knowentry
+{
+  Term term;			//!< Indexed term
+  unsigned int hv;		//!< Cached hash value (of the term or its key)
+  struct knowentry *next;	//!< Next node in this bucket
+};
+
+//! Chained hash index on terms
+struct knowhash
+{
+  unsigned int size;		//!< Number of buckets, a power of two
+  unsigned int count;		//!< Number of nodes
+  struct knowentry **bucket;	//!< Buckets
+};
+
+//! Create an empty hash index
+static struct knowhash *
+knowhashCreate (const unsigned int size)
+{
+  struct knowhash *h;
+
+  statsMalloc (MEM_KNOWLEDGE, sizeof (struct knowhash));
+  h = (struct knowhash *) malloc (sizeof (struct knowhash));
+  h->size = size;
+  h->count = 0;
+  statsMalloc (MEM_KNOWLEDGE, size * sizeof (struct knowentry *));
+  h->bucket =
+    (struct knowentry **) calloc (size, sizeof (struct knowentry *));
+  return h;
+}
+
+//! Destroy a hash index (not the terms)
+static void
+knowhashDestroy (struct knowhash *h)
+{
+  unsigned int i;
+
+  if (h == NULL)
+    return;
+  for (i = 0; i < h->size; i++)
+    {
+      struct knowentry *e;
+
+      e = h->bucket[i];
+      while (e != NULL)
+	{
+	  struct knowentry *next;
+
+	  next = e->next;
+	  statsFree (MEM_KNOWLEDGE, sizeof (struct knowentry));
+	  free (e);
+	  e = next;
+	}
+    }
+  statsFree (MEM_KNOWLEDGE, h->size * sizeof (struct knowentry *));
+  free (h->bucket);
+  statsFree (MEM_KNOWLEDGE, sizeof (struct knowhash));
+  free (h);
+}
+
+//! Insert a node, without checking for duplicates or resizing
+static void
+knowhashInsert (struct knowhash *h, const Term t, const unsigned int hv)
+{
+  struct knowentry *e;
+  unsigned int i;
+
+  statsMalloc (MEM_KNOWLEDGE, sizeof (struct knowentry));
+  e = (struct knowentry *) malloc (sizeof (struct knowentry));
+  e->term = t;
+  e->hv = hv;
+  i = hv & (h->size - 1);
+  e->next = h->bucket[i];
+  h->bucket[i] = e;
+  h->count++;
+}
+
+//! Add a term under a hash value, doubling the number of buckets when needed
+static void
+knowhashAdd (struct knowhash *h, const Term t, const unsigned int hv)
+{
+  if (h->count >= h->size)
+    {
+      struct knowentry **old;
+      unsigned int oldsize;
+      unsigned int i;
+
+      old = h->bucket;
+      oldsize = h->size;
+      h->size = 2 * oldsize;
+      statsMalloc (MEM_KNOWLEDGE, h->size * sizeof (struct knowentry *));
+      h->bucket =
+	(struct knowentry **) calloc (h->size, sizeof (struct knowentry *));
+      for (i = 0; i < oldsize; i++)
+	{
+	  struct knowentry *e;
+
+	  e = old[i];
+	  while (e != NULL)
+	    {
+	      struct knowentry *next;
+	      unsigned int j;
+
+	      next = e->next;
+	      j = e->hv & (h->size - 1);
+	      e->next = h->bucket[j];
+	      h->bucket[j] = e;
+	      e = next;
+	    }
+	}
+      statsFree (MEM_KNOWLEDGE, oldsize * sizeof (struct knowentry *));
+      free (old);
+    }
+  knowhashInsert (h, t, hv);
+}
+
+//! Copy a hash index (the terms are shared)
+static struct knowhash *
+knowhashDuplicate (const struct knowhash *h)
+{
+  struct knowhash *hnew;
+  unsigned int i;
+
+  hnew = knowhashCreate (h->size);
+  for (i = 0; i < h->size; i++)
+    {
+      struct knowentry *e;
+
+      for (e = h->bucket[i]; e != NULL; e = e->next)
+	{
+	  knowhashInsert (hnew, e->term, e->hv);
+	}
+    }
+  return hnew;
+}
+
+//! Remove the node for this exact term pointer, if any
+static void
+knowhashRemove (struct knowhash *h, const Term t, const unsigned int hv)
+{
+  struct knowentry **ep;
+
+  ep = &(h->bucket[hv & (h->size - 1)]);
+  while (*ep != NULL)
+    {
+      if ((*ep)->term == t)
+	{
+	  struct knowentry *e;
+
+	  e = *ep;
+	  *ep = e->next;
+	  statsFree (MEM_KNOWLEDGE, sizeof (struct knowentry));
+	  free (e);
+	  h->count--;
+	  return;
+	}
+      ep = &((*ep)->next);
+    }
+}
+
+//! Structural hash of a term, following substitutions
+/**
+ * Equal terms (in the sense of isTermEqual) have equal hashes.
+ */
+static unsigned int
+termHash (Term t)
+{
+  t = deVar (t);
+  if (t == NULL)
+    return 0;
+  if (realTermLeaf (t))
+    {
+      unsigned int h;
+
+      h = (unsigned int) ((size_t) TermSymb (t) >> 3);
+      h ^= (unsigned int) TermRunid (t) * 2654435761u;
+      return h ^ (unsigned int) t->type;
+    }
+  if (realTermEncrypt (t))
+    {
+      return (termHash (TermOp (t)) * 31 + termHash (TermKey (t))) *
+	1000003u + ENCRYPT;
+    }
+  return (termHash (TermOp1 (t)) * 31 + termHash (TermOp2 (t))) *
+    1000003u + TUPLE;
+}
+
+//! Determine whether a term contains no open (or role-local) variables
+/**
+ * Such terms can be hashed once and stay in the index.
+ */
+static int
+isTermClosed (Term t)
+{
+  t = deVar (t);
+  if (t == NULL)
+    return true;
+  if (realTermLeaf (t))
+    {
+      return (t->type != VARIABLE && TermRunid (t) != -3);
+    }
+  if (realTermEncrypt (t))
+    {
+      return (isTermClosed (TermOp (t)) && isTermClosed (TermKey (t)));
+    }
+  return (isTermClosed (TermOp1 (t)) && isTermClosed (TermOp2 (t)));
+}
+
+//! Add a term of knowledge::basic or knowledge::encrypt to the indices
+static void
+knowledgeIndex (Knowledge know, Term t)
+{
+  if (isTermClosed (t))
+    knowhashAdd (know->index, t, termHash (t));
+  else
+    know->loose = termlistAdd (know->loose, t);
+  if (realTermEncrypt (t))
+    {
+      if (isTermClosed (TermKey (t)))
+	knowhashAdd (know->keyindex, t, termHash (TermKey (t)));
+      else
+	know->loosekeys = termlistAdd (know->loosekeys, t);
+    }
+}
+
+//! Remove a term of knowledge::encrypt from the indices
+static void
+knowledgeUnindex (Knowledge know, Term t)
+{
+  Termlist tl;
+
+  tl = termlistFind (know->loose, t);
+  if (tl != NULL)
+    know->loose = termlistDelTerm (tl);
+  else
+    knowhashRemove (know->index, t, termHash (t));
+  tl = termlistFind (know->loosekeys, t);
+  if (tl != NULL)
+    know->loosekeys = termlistDelTerm (tl);
+  else
+    knowhashRemove (know->keyindex, t, termHash (TermKey (t)));
+}
+
+//! Check whether a term occurs in knowledge::basic or knowledge::encrypt
+static int
+knowledgeHas (const Knowledge know, Term t)
+{
+  struct knowentry *e;
+  unsigned int hv;
+
+  hv = termHash (t);
+  for (e = know->index->bucket[hv & (know->index->size - 1)]; e != NULL;
+       e = e->next)
+    {
+      if (e->hv == hv && isTermEqual (e->term, t))
+	return true;
+    }
+  return inTermlist (know->loose, t);
+}
+
+//! Check whether some term of knowledge::encrypt has this key
+static int
+knowledgeHasKey (const Knowledge know, Term key)
+{
+  struct knowentry *e;
+  Termlist tl;
+  unsigned int hv;
+
+  hv = termHash (key);
+  for (e = know->keyindex->bucket[hv & (know->keyindex->size - 1)];
+       e != NULL; e = e->next)
+    {
+      if (e->hv == hv && isTermEqual (TermKey (e->term), key))
+	return true;
+    }
+  for (tl = know->loosekeys; tl != NULL; tl = tl->next)
+    {
+      if (isTermEqual (TermKey (tl->term), key))
+	return true;
+    }
+  return false;
+}
 
 /*
  * Knowledge stuff
@@ -57,6 +361,7 @@ knowledgeDone (void)
 Knowledge
 makeKnowledge ()
 {
+  statsMalloc (MEM_KNOWLEDGE, sizeof (struct knowledge));
   return (Knowledge) malloc (sizeof (struct knowledge));
 }
 
@@ -76,6 +381,10 @@ emptyKnowledge ()
   know->inversekeyfunctions = NULL;
   know->vars = NULL;
   know->publicfunctions = NULL;
+  know->index = knowhashCreate (KNOWHASH_INITIAL);
+  know->keyindex = knowhashCreate (KNOWHASH_INITIAL);
+  know->loose = NULL;
+  know->loosekeys = NULL;
   return know;
 }
 
@@ -105,6 +414,10 @@ knowledgeDuplicate (Knowledge know)
   newknow->inversekeys = know->inversekeys;
   newknow->inversekeyfunctions = know->inversekeyfunctions;
   newknow->publicfunctions = termlistShallow (know->publicfunctions);
+  newknow->index = knowhashDuplicate (know->index);
+  newknow->keyindex = knowhashDuplicate (know->keyindex);
+  newknow->loose = termlistShallow (know->loose);
+  newknow->loosekeys = termlistShallow (know->loosekeys);
   return newknow;
 }
 
@@ -122,6 +435,11 @@ knowledgeDelete (Knowledge know)
       termlistDelete (know->encrypt);
       termlistDelete (know->vars);
       termlistDelete (know->publicfunctions);
+      termlistDelete (know->loose);
+      termlistDelete (know->loosekeys);
+      knowhashDestroy (know->index);
+      knowhashDestroy (know->keyindex);
+      statsFree (MEM_KNOWLEDGE, sizeof (struct knowledge));
       free (know);
     }
 }
@@ -143,6 +461,12 @@ knowledgeDestroy (Knowledge know)
       // termlistDestroy(know->inversekeys);
       // termlistDestroy(know->inversekeyfunctions);
       termlistDestroy (know->publicfunctions);
+      // The loose lists only index terms of basic and encrypt
+      termlistDelete (know->loose);
+      termlistDelete (know->loosekeys);
+      knowhashDestroy (know->index);
+      knowhashDestroy (know->keyindex);
+      statsFree (MEM_KNOWLEDGE, sizeof (struct knowledge));
       free (know);
     }
 }
@@ -186,6 +510,7 @@ knowledgeAddTerm (Knowledge know, Term term)
   if (isTermLeaf (term))
     {
       know->basic = termlistAdd (know->basic, term);
+      knowledgeIndex (know, term);
     }
   if (term->type == ENCRYPT)
     {
@@ -198,12 +523,14 @@ knowledgeAddTerm (Knowledge know, Term term)
 	    {
 	      /* we know the op now, but not the key, so add it anyway */
 	      know->encrypt = termlistAdd (know->encrypt, term);
+	      knowledgeIndex (know, term);
 	    }
 	}
       else
 	{
 	  /* we cannot decrypt it, and from the initial test we know we could not construct it */
 	  know->encrypt = termlistAdd (know->encrypt, term);
+	  knowledgeIndex (know, term);
 	}
       termDelete (invkey);
     }
@@ -223,11 +550,18 @@ knowledgeSimplify (Knowledge know, Term key)
   Termlist scan = know->encrypt;
   Term invkey = inverseKey (know, key);
 
+  /* nothing is unlocked by this key: avoid the scan */
+  if (!knowledgeHasKey (know, invkey))
+    {
+      termDelete (invkey);
+      return;
+    }
   while (scan != NULL)
     {
       if (isTermEqual (TermKey (scan->term), invkey))
 	{
 	  tldecrypts = termlistAdd (tldecrypts, TermOp (scan->term));
+	  knowledgeUnindex (know, scan->term);
 	  know->encrypt = termlistDelTerm (scan);
 	  scan = know->encrypt;
 	}
@@ -295,17 +629,17 @@ inKnowledge (const Knowledge know, Term term)
   term = deVar (term);
   if (isTermLeaf (term))
     {
-      return inTermlist (know->basic, term);
+      return knowledgeHas (know, term);
     }
   if (term->type == ENCRYPT)
     {
-      return inTermlist (know->encrypt, term) ||
+      return knowledgeHas (know, term) ||
 	(inKnowledge (know, TermKey (term))
 	 && inKnowledge (know, TermOp (term)));
     }
   if (term->type == TUPLE)
     {
-      return (inTermlist (know->encrypt, term) ||
+      return (knowledgeHas (know, term) ||
 	      (inKnowledge (know, TermOp1 (term)) &&
 	       inKnowledge (know, TermOp2 (term))));
     }
@@ -388,7 +722,7 @@ knowledgeSet (const Knowledge know)
 int
 inKnowledgeSet (const Knowledge know, Term t)
 {
-  return (inTermlist (know->basic, t) || inTermlist (know->encrypt, t));
+  return knowledgeHas (know, t);
 }
 
 //! check whether any substitutions where made in a knowledge set.
@@ -46,6 +46,14 @@ struct knowledge
   Termlist vars;		// special: denotes unsubstituted variables
   //! A list of hash functions
   Termlist publicfunctions;
+  //! Hash index on the closed terms of knowledge::basic and knowledge::encrypt.
+  struct knowhash *index;
+  //! Hash index on the closed-key terms of knowledge::encrypt, by their key.
+  struct knowhash *keyindex;
+  //! Terms of knowledge::basic and knowledge::encrypt not in the index.
+  Termlist loose;
+  //! Terms of knowledge::encrypt not in the key index.
+  Termlist loosekeys;
 };
 
 //! Shorthand for knowledge pointer.
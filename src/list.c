@@ -28,6 +28,7 @@
 
 #include "list.h"
 #include "mymalloc.h"
+#include "stats.h"
 
 //! Make a node
 List
@@ -35,6 +36,7 @@ list_create (const void *data)
 {
   List newlist;
 
+  statsMalloc (MEM_LISTS, sizeof (struct list_struct));
   newlist = (List) malloc (sizeof (struct list_struct));
   newlist->prev = NULL;
   newlist->next = NULL;
@@ -167,6 +169,7 @@ list_delete (List list)
 
       prenode = list->prev;
       postnode = list->next;
+      statsFree (MEM_LISTS, sizeof (struct list_struct));
       free (list);
       if (postnode != NULL)
 	{
@@ -259,6 +262,7 @@ list_destroy (List list)
 
       node = list;
       list = list->next;
+      statsFree (MEM_LISTS, sizeof (struct list_struct));
       free (node);
     }
 }
@@ -74,6 +74,9 @@
 #include "claim.h"
 #include "arachne.h"
 #include "xmlout.h"
+#include "jsonout.h"
+#include "stats.h"
+#include "timeline.h"
 
 //! The global system state pointer
 System sys;
@@ -99,6 +102,7 @@ main (int argc, char **argv)
   int exitcode = EXIT_NOATTACK;
 
   /* initialize symbols */
+  statsInit ();
   termsInit ();
   termmapsInit ();
   termlistsInit ();
@@ -114,6 +118,7 @@ main (int argc, char **argv)
 
   /* process any command-line switches */
   switchesInit (argc, argv);
+  timelineInit ();
 
   /* process colors */
   colorInit ();
@@ -129,7 +134,9 @@ main (int argc, char **argv)
 
   /* parse input */
 
+  timelineBegin ("parse");
   yyparse ();
+  timelineEnd ();
 #ifdef DEBUG
   if (DEBUGL (1))
     tacPrint (spdltac);
@@ -138,7 +145,9 @@ main (int argc, char **argv)
   /* compile */
 
   // Compile no runs for Arachne and preprocess
+  timelineBegin ("compile");
   compile (spdltac, 0);
+  timelineEnd ();
   scanner_cleanup ();
 
 #ifdef DEBUG
@@ -188,6 +197,8 @@ main (int argc, char **argv)
   /* xml init */
   if (switches.xml)
     xmlOutInit ();
+  if (switches.json)
+    jsonOutInit ();
 
   /* model check system */
 #ifdef DEBUG
@@ -206,9 +217,28 @@ main (int argc, char **argv)
 
   exitcode = EXIT_ATTACK;
 
+  timelineBegin ("output");
+
+  /* search counters */
+  if (switches.stats)
+    {
+      if (switches.xml)
+	xmlOutStatistics (sys);
+      else if (!switches.json)
+	statsPrint (sys);
+    }
+
   /* xml closeup */
   if (switches.xml)
     xmlOutDone ();
+  if (switches.json)
+    {
+      jsonOutTotals (sys);
+      jsonOutDone ();
+    }
+
+  timelineEnd ();
+  timelineDone ();
 
   /*
    * Now we clean up any memory that was allocated.
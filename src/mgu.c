@@ -28,6 +28,7 @@
 #include "specialterm.h"
 #include "switches.h"
 #include "arachne.h"
+#include "stats.h"
 
 /*
    Most General Unifier
@@ -146,6 +147,21 @@ unify_callback_wrapper (Termlist tl, struct state_mgu_tmp *ptr_tmpstate)
 		ptr_tmpstate->oldcallback, ptr_tmpstate->oldstate);
 }
 
+//! Call back with a unifier
+/**
+ * Only counts the unifiers that leave unify, i.e. not the partial ones
+ * handed to unify_callback_wrapper.
+ */
+static int
+unifyFound (int (*callback) (), void *state, Termlist tl)
+{
+  if (callback != (int (*)()) unify_callback_wrapper)
+    {
+      stats.unifiers++;
+    }
+  return callback (tl, state);
+}
+
 int
 callsubst (int (*callback) (), void *state, Termlist tl, Term t, Term tsubst)
 {
@@ -156,7 +172,7 @@ callsubst (int (*callback) (), void *state, Termlist tl, Term t, Term tsubst)
   showSubst (t);
 #endif
   tl = termlistAdd (tl, t);
-  proceed = callback (tl, state);
+  proceed = unifyFound (callback, state, tl);
   tl = termlistDelTerm (tl);
   t->subst = NULL;
   return proceed;
@@ -177,12 +193,14 @@ callsubst (int (*callback) (), void *state, Termlist tl, Term t, Term tsubst)
 int
 unify (Term t1, Term t2, Termlist tl, int (*callback) (), void *state)
 {
+  stats.unify++;
+
   /* added for speed */
   t1 = deVar (t1);
   t2 = deVar (t2);
   if (t1 == t2)
     {
-      return callback (tl, state);
+      return unifyFound (callback, state, tl);
     }
 
   if (!(hasTermVariable (t1) || hasTermVariable (t2)))
@@ -191,7 +209,7 @@ unify (Term t1, Term t2, Termlist tl, int (*callback) (), void *state)
       if (isTermEqual (t1, t2))
 	{
 	  // Equal!
-	  return callback (tl, state);
+	  return unifyFound (callback, state, tl);
 	}
       else
 	{
@@ -302,6 +320,7 @@ int
 keycallback (Termlist tl, struct su_kcb_state *ptr_kcb_state)
 {
   assert (ptr_kcb_state != NULL);
+  stats.subterm_unifiers++;
   return ptr_kcb_state->callback (tl, ptr_kcb_state->keylist,
 				  ptr_kcb_state->oldstate);
 }
@@ -332,6 +351,7 @@ subtermUnify (Term tbig, Term tsmall, Termlist tl, Termlist keylist,
   kcb_state.callback = callback;
   kcb_state.keylist = keylist;
 
+  stats.subterm_unify++;
   proceed = true;
 
   // Devar
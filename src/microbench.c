@@ -0,0 +1,637 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file microbench.c
+ * \brief Microbenchmarks of the core kernels
+ *
+ * A separate executable (scyther-microbench, not part of 'all') that runs
+ * the kernels the search spends most of its time in: unify, subtermUnify,
+ * isTermEqualFn, termDuplicate, transitive_closure, inKnowledge and
+ * termlistConjunct. It reports the time and the number of allocated terms
+ * and termlists per operation, such that changes to term.c, mgu.c,
+ * warshall.c and knowledge.c can be evaluated in isolation.
+ *
+ * The kernels run on synthetic terms of configurable depth and width and,
+ * if a protocol file is given, on the messages of its roles. Any arguments
+ * after the options of the benchmark are handled like those of scyther
+ * itself, e.g.
+ *
+ *   scyther-microbench --iterations=200000 ../protocols/yahalom.spdl --match=2
+ */
+
+/* clock_gettime is not part of C11 */
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "system.h"
+#include "term.h"
+#include "termlist.h"
+#include "termmap.h"
+#include "mgu.h"
+#include "knowledge.h"
+#include "warshall.h"
+#include "symbol.h"
+#include "switches.h"
+#include "compiler.h"
+#include "arachne.h"
+#include "tac.h"
+#include "stats.h"
+#include "error.h"
+
+#if defined(linux) || defined(__linux__) || defined(__APPLE__)
+#define MICROBENCH_MONOTONIC
+#endif
+
+//! The global system state pointer (main.c is not linked in)
+System sys;
+
+//! Pointer to the tac node container
+extern struct tacnode *spdltac;
+
+void scanner_cleanup (void);
+void strings_cleanup (void);
+int yyparse (void);
+
+//! Number of different leaves in the synthetic terms
+#define LEAVES 24
+
+//! Terms to run the kernels on
+struct termset
+{
+  const char *name;		//!< Name in the report
+  int count;			//!< Number of terms
+  Term *terms;			//!< The terms
+  Term *patterns;		//!< Terms to unify with them
+  Term *parts;			//!< Terms to look for in them
+  Term *copies;			//!< Deep copies of the terms
+  Knowledge know;		//!< Knowledge to derive the terms from
+  unsigned int *graph;		//!< Dependency graph (n x n bits)
+  int nodes;			//!< Nodes in the graph
+};
+
+static long iterations = 100000;	//!< Operations per kernel
+static int depth = 4;		//!< Depth of the synthetic terms
+static int width = 3;		//!< Width of the tuples in them
+static int nodes = 64;		//!< Nodes of the synthetic graph
+static char *kernel = NULL;	//!< Only run this kernel, if set
+
+static unsigned int seed;	//!< State of the pseudo random generator
+static Term consts[LEAVES];	//!< Constants of the synthetic terms
+static Term vars[LEAVES];	//!< Variables of the synthetic terms
+static Term key;		//!< Key of the synthetic encryptions
+
+/*
+ * Measurements
+ */
+
+//! Current time in nanoseconds
+static double
+benchNow (void)
+{
+#ifdef MICROBENCH_MONOTONIC
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+#else
+  return (double) clock () * 1e9 / CLOCKS_PER_SEC;
+#endif
+}
+
+//! Start of a measurement
+struct benchmark
+{
+  double time;
+  states_t terms;
+  states_t termlists;
+};
+
+//! Start measuring
+static void
+benchStart (struct benchmark *bm)
+{
+  bm->terms = stats.memory[MEM_TERMS].allocations;
+  bm->termlists = stats.memory[MEM_TERMLISTS].allocations;
+  bm->time = benchNow ();
+}
+
+//! Report a measurement of ops operations
+static void
+benchReport (const struct benchmark *bm, const char *name,
+	     const struct termset *set, const long ops)
+{
+  double ns;
+
+  ns = benchNow () - bm->time;
+  printf ("%s\t%s\t%li\t%.1f\t%.2f\t%.2f\n", name, set->name, ops,
+	  ns / ops,
+	  (double) (stats.memory[MEM_TERMS].allocations - bm->terms) / ops,
+	  (double) (stats.memory[MEM_TERMLISTS].allocations -
+		    bm->termlists) / ops);
+  fflush (stdout);
+}
+
+//! Whether to run a kernel
+static int
+benchSelected (const char *name)
+{
+  return (kernel == NULL || strcmp (kernel, name) == 0);
+}
+
+/*
+ * Kernels
+ */
+
+//! Count the unifiers
+static int
+benchUnifier (Termlist tl, long *found)
+{
+  (*found)++;
+  return true;
+}
+
+//! Count the unifiers of subterms
+static int
+benchSubtermUnifier (Termlist tl, Termlist keylist, long *found)
+{
+  (*found)++;
+  return true;
+}
+
+//! Run all selected kernels on a term set
+static void
+benchSet (const struct termset *set)
+{
+  struct benchmark bm;
+  long i, found;
+  int n;
+
+  n = set->count;
+  if (n == 0)
+    {
+      return;
+    }
+
+  if (benchSelected ("unify"))
+    {
+      found = 0;
+      benchStart (&bm);
+      for (i = 0; i < iterations; i++)
+	{
+	  unify (set->patterns[i % n], set->terms[i % n], NULL,
+		 benchUnifier, &found);
+	}
+      benchReport (&bm, "unify", set, iterations);
+    }
+
+  if (benchSelected ("subtermUnify"))
+    {
+      found = 0;
+      benchStart (&bm);
+      for (i = 0; i < iterations; i++)
+	{
+	  subtermUnify (set->terms[i % n], set->parts[i % n], NULL, NULL,
+			benchSubtermUnifier, &found);
+	}
+      benchReport (&bm, "subtermUnify", set, iterations);
+    }
+
+  if (benchSelected ("isTermEqualFn"))
+    {
+      found = 0;
+      benchStart (&bm);
+      for (i = 0; i < iterations; i++)
+	{
+	  found += isTermEqualFn (set->terms[i % n], set->copies[i % n]);
+	}
+      benchReport (&bm, "isTermEqualFn", set, iterations);
+    }
+
+  if (benchSelected ("termDuplicate"))
+    {
+      benchStart (&bm);
+      for (i = 0; i < iterations; i++)
+	{
+	  termDelete (termDuplicate (set->terms[i % n]));
+	}
+      benchReport (&bm, "termDuplicate", set, iterations);
+    }
+
+  if (benchSelected ("inKnowledge"))
+    {
+      found = 0;
+      benchStart (&bm);
+      for (i = 0; i < iterations; i++)
+	{
+	  found += inKnowledge (set->know, set->terms[i % n]);
+	}
+      benchReport (&bm, "inKnowledge", set, iterations);
+    }
+
+  if (benchSelected ("termlistConjunct"))
+    {
+      Termlist *leaves;
+
+      // The leaves of each term, and the next one
+      leaves = (Termlist *) malloc (n * sizeof (Termlist));
+      for (i = 0; i < n; i++)
+	{
+	  leaves[i] = termlistAddBasic (NULL, set->terms[i]);
+	}
+      benchStart (&bm);
+      for (i = 0; i < iterations; i++)
+	{
+	  termlistDelete (termlistConjunct (leaves[i % n],
+					    leaves[(i + 1) % n]));
+	}
+      benchReport (&bm, "termlistConjunct", set, iterations);
+      for (i = 0; i < n; i++)
+	{
+	  termlistDelete (leaves[i]);
+	}
+      free (leaves);
+    }
+
+  if (set->graph != NULL && benchSelected ("transitive_closure"))
+    {
+      unsigned int *G;
+      size_t size;
+      long ops;
+
+      // The closure is idempotent, so we start from a copy every time
+      size = set->nodes * WORDSIZE (set->nodes) * sizeof (unsigned int);
+      G = (unsigned int *) malloc (size);
+      ops = iterations / 100 + 1;
+      benchStart (&bm);
+      for (i = 0; i < ops; i++)
+	{
+	  memcpy (G, set->graph, size);
+	  transitive_closure (G, set->nodes);
+	}
+      benchReport (&bm, "transitive_closure", set, ops);
+      free (G);
+    }
+}
+
+/*
+ * Term sets
+ */
+
+//! Pseudo random number below n, the same on every platform
+static int
+benchRandom (const int n)
+{
+  seed = seed * 1103515245u + 12345u;
+  return (int) ((seed >> 16) % (unsigned int) n);
+}
+
+//! Synthetic term: tuples of width subterms, encrypted at every odd level
+/**
+ * With open set, every third constant is replaced by a variable, such
+ * that the result unifies with the closed term made from the same seed.
+ */
+static Term
+syntheticTerm (const int d, const int open)
+{
+  Term t;
+  int i;
+
+  if (d == 0)
+    {
+      i = benchRandom (LEAVES);
+      if (open && i % 3 == 0)
+	{
+	  return vars[i];
+	}
+      return consts[i];
+    }
+  t = syntheticTerm (d - 1, open);
+  for (i = 1; i < width; i++)
+    {
+      t = makeTermTuple (syntheticTerm (d - 1, open), t);
+    }
+  if (d % 2 == 1)
+    {
+      t = makeTermEncrypt (t, key);
+    }
+  return t;
+}
+
+//! Allocate the term arrays of a set
+static void
+setAllocate (struct termset *set, const char *name, const int count)
+{
+  set->name = name;
+  set->count = count;
+  set->terms = (Term *) malloc (count * sizeof (Term));
+  set->patterns = (Term *) malloc (count * sizeof (Term));
+  set->parts = (Term *) malloc (count * sizeof (Term));
+  set->copies = (Term *) malloc (count * sizeof (Term));
+  set->know = NULL;
+  set->graph = NULL;
+  set->nodes = 0;
+}
+
+//! Add an edge to the graph of a set
+static void
+setEdge (struct termset *set, const int from, const int to)
+{
+  set->graph[from * WORDSIZE (set->nodes) + to / BITS_PER_WORD] |=
+    1u << (to % BITS_PER_WORD);
+}
+
+//! Synthetic terms, with their leaves as knowledge and a random graph
+static void
+syntheticSet (struct termset *set)
+{
+  int i;
+
+  for (i = 0; i < LEAVES; i++)
+    {
+      char *name;
+
+      name = (char *) malloc (8);
+      sprintf (name, "c%i", i);
+      consts[i] = makeTermType (GLOBAL, symbolSysConst (name), -1);
+      name = (char *) malloc (8);
+      sprintf (name, "V%i", i);
+      vars[i] = makeTermType (VARIABLE, symbolSysConst (name), 0);
+    }
+  key = makeTermType (GLOBAL, symbolSysConst ("k"), -1);
+
+  setAllocate (set, "synthetic", 16);
+  set->know = emptyKnowledge ();
+  knowledgeAddTerm (set->know, key);
+  for (i = 0; i < LEAVES; i++)
+    {
+      knowledgeAddTerm (set->know, consts[i]);
+    }
+  for (i = 0; i < set->count; i++)
+    {
+      seed = i + 1;
+      set->terms[i] = syntheticTerm (depth, false);
+      seed = i + 1;
+      set->patterns[i] = syntheticTerm (depth, true);
+      set->parts[i] = syntheticTerm (depth > 0 ? depth - 1 : 0, true);
+      set->copies[i] = termDuplicateDeep (set->terms[i]);
+    }
+
+  // A chain with a few random shortcuts, like the ordering of a semitrace
+  set->nodes = nodes;
+  set->graph = (unsigned int *) calloc (nodes * WORDSIZE (nodes),
+					sizeof (unsigned int));
+  seed = 1;
+  for (i = 0; i + 1 < nodes; i++)
+    {
+      setEdge (set, i, i + 1);
+      setEdge (set, benchRandom (nodes), benchRandom (nodes));
+    }
+}
+
+//! The messages of the roles of the protocols, with one run of each role
+/**
+ * Each message is unified with, and searched for, the next message. The
+ * graph orders the events of each role and connects sends to the receives
+ * with the same label.
+ */
+static void
+protocolSet (struct termset *set)
+{
+  Protocol p;
+  Role r;
+  Roledef rd, rd2;
+  int count, i, j;
+
+  count = 0;
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      for (r = p->roles; r != NULL; r = r->next)
+	{
+	  for (rd = r->roledef; rd != NULL; rd = rd->next)
+	    {
+	      if (rd->type == SEND || rd->type == RECV)
+		{
+		  count++;
+		}
+	    }
+	}
+    }
+
+  setAllocate (set, "protocol", count);
+  set->know = sys->know;
+  set->nodes = count;
+  set->graph = (unsigned int *) calloc (count * WORDSIZE (count),
+					sizeof (unsigned int));
+  i = 0;
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      for (r = p->roles; r != NULL; r = r->next)
+	{
+	  int first;
+
+	  first = i;
+	  for (rd = r->roledef; rd != NULL; rd = rd->next)
+	    {
+	      if (rd->type == SEND || rd->type == RECV)
+		{
+		  set->terms[i] = rd->message;
+		  set->copies[i] = termDuplicateDeep (rd->message);
+		  if (i > first)
+		    {
+		      setEdge (set, i - 1, i);
+		    }
+		  i++;
+		}
+	    }
+	}
+    }
+  for (i = 0; i < count; i++)
+    {
+      set->patterns[i] = set->terms[(i + 1) % count];
+      set->parts[i] = set->terms[(i + 1) % count];
+    }
+
+  // Sends before the receives with the same label
+  i = 0;
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      for (r = p->roles; r != NULL; r = r->next)
+	{
+	  for (rd = r->roledef; rd != NULL; rd = rd->next)
+	    {
+	      if (rd->type == SEND)
+		{
+		  Protocol p2;
+		  Role r2;
+
+		  j = 0;
+		  for (p2 = sys->protocols; p2 != NULL; p2 = p2->next)
+		    {
+		      for (r2 = p2->roles; r2 != NULL; r2 = r2->next)
+			{
+			  for (rd2 = r2->roledef; rd2 != NULL;
+			       rd2 = rd2->next)
+			    {
+			      if (rd2->type == RECV
+				  && isTermEqual (rd->label, rd2->label))
+				{
+				  setEdge (set, i, j);
+				}
+			      if (rd2->type == SEND || rd2->type == RECV)
+				{
+				  j++;
+				}
+			    }
+			}
+		    }
+		}
+	      if (rd->type == SEND || rd->type == RECV)
+		{
+		  i++;
+		}
+	    }
+	}
+    }
+}
+
+/*
+ * Main
+ */
+
+//! Integer value of an option
+static int
+benchInteger (const char *arg, const char *option)
+{
+  int len;
+
+  len = strlen (option);
+  if (strncmp (arg, option, len) == 0 && arg[len] == '=')
+    {
+      return atoi (arg + len + 1);
+    }
+  return -1;
+}
+
+//! Usage
+static void
+benchUsage (void)
+{
+  printf ("Usage: scyther-microbench [options] [FILE [scyther options]]\n");
+  printf ("\n");
+  printf ("  --iterations=<int>  operations per kernel [%li]\n", iterations);
+  printf ("  --depth=<int>       depth of the synthetic terms [%i]\n", depth);
+  printf ("  --width=<int>       width of their tuples [%i]\n", width);
+  printf ("  --nodes=<int>       nodes of the synthetic graph [%i]\n", nodes);
+  printf ("  --kernel=<name>     only run this kernel\n");
+  printf ("\n");
+  printf ("Reports, tab separated: kernel, term set, operations,\n");
+  printf ("nanoseconds, terms and termlists allocated per operation.\n");
+}
+
+//! The main body, as called by the environment.
+int
+main (int argc, char **argv)
+{
+  struct termset synthetic, protocol;
+  int protocolfile;
+  int i, n;
+
+  // Our own options come first
+  for (i = 1; i < argc && strncmp (argv[i], "--", 2) == 0; i++)
+    {
+      if ((n = benchInteger (argv[i], "--iterations")) > 0)
+	iterations = n;
+      else if ((n = benchInteger (argv[i], "--depth")) >= 0)
+	depth = n;
+      else if ((n = benchInteger (argv[i], "--width")) > 0)
+	width = n;
+      else if ((n = benchInteger (argv[i], "--nodes")) > 0)
+	nodes = n;
+      else if (strncmp (argv[i], "--kernel=", 9) == 0)
+	kernel = argv[i] + 9;
+      else if (strcmp (argv[i], "--help") == 0)
+	{
+	  benchUsage ();
+	  return 0;
+	}
+      else
+	break;
+    }
+  // Is a protocol file left for scyther?
+  protocolfile = false;
+  for (n = i; n < argc; n++)
+    {
+      if (argv[n][0] != '-')
+	{
+	  protocolfile = true;
+	}
+    }
+
+  /* initialize symbols */
+  statsInit ();
+  termsInit ();
+  termmapsInit ();
+  termlistsInit ();
+  knowledgeInit ();
+  symbolsInit ();
+  tacInit ();
+  if (i < argc)
+    {
+      argv[i - 1] = argv[0];
+      switchesInit (argc - i + 1, argv + i - 1);
+    }
+  else
+    {
+      // Scyther wants an argument; stdin is not read without a file
+      char *noargs[] = { argv[0], "-" };
+
+      switchesInit (2, noargs);
+    }
+
+  sys = systemInit ();
+  sys->know = emptyKnowledge ();
+  compilerInit (sys);
+  if (protocolfile)
+    {
+      yyparse ();
+      compile (spdltac, 0);
+      scanner_cleanup ();
+    }
+  systemStart (sys);
+  sys->traceKnow[0] = sys->know;
+  arachneInit (sys);
+
+  // subtermUnify marks the current claim as incomplete for open variables
+  sys->current_claim = (Claimlist) calloc (1, sizeof (struct claimlist));
+
+  printf ("# kernel\tset\tops\tns/op\tterms/op\ttermlists/op\n");
+  syntheticSet (&synthetic);
+  benchSet (&synthetic);
+  if (protocolfile)
+    {
+      protocolSet (&protocol);
+      benchSet (&protocol);
+    }
+  return 0;
+}
@@ -0,0 +1,480 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file profile.c
+ * \brief Proof tree profiling (--profile)
+ *
+ * Attributes the states and CPU time of each subtree of the proof tree to
+ * the decision that created it: the pattern of the goal that was selected
+ * in bind_goal_all_options, with the way it was bound, and the send event
+ * of a role that a regular binding used. After each claim, the hottest
+ * goal patterns and send events are reported.
+ *
+ * Subtrees are nested, so the figures are inclusive: the states below a
+ * goal also count for the goals that were selected before it. When a goal
+ * pattern or send event occurs again within its own subtree, only the
+ * outermost occurrence counts, like recursive calls in a profiler.
+ *
+ * A goal pattern is the goal term without its run identifiers, such that
+ * the same goal in different runs is counted together.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+#include "term.h"
+#include "role.h"
+#include "switches.h"
+#include "error.h"
+
+//! Profile of a goal pattern
+struct profilegoal
+{
+  Term pattern;			//!< Goal without run identifiers
+  unsigned int hash;		//!< Hash of the pattern
+  int active;			//!< Number of enclosing subtrees for it
+  states_t tries[PROFILE_KINDS];	//!< Subtrees per binding kind
+  states_t states[PROFILE_KINDS];	//!< States below them
+  clock_t ticks[PROFILE_KINDS];	//!< CPU time below them
+};
+
+//! Profile of a send event of a role
+struct profilesend
+{
+  Protocol protocol;
+  Role role;
+  Roledef rd;			//!< The send event
+  int index;			//!< Its index in the role
+  int active;			//!< Number of enclosing subtrees for it
+  states_t tries;		//!< Goals bound to it
+  states_t states;		//!< States below them
+  clock_t ticks;		//!< CPU time below them
+};
+
+//! Goal patterns (open addressing on the hash, NULL for a free slot)
+static Profilegoal *goals;
+static int goalsize;
+static int goalcount;
+
+//! Send events (there are few of them, so a plain array)
+static Profilesend *sends;
+static int sendsize;
+static int sendcount;
+
+//! Init
+void
+profileInit (void)
+{
+  goals = NULL;
+  goalsize = 0;
+  goalcount = 0;
+  sends = NULL;
+  sendsize = 0;
+  sendcount = 0;
+}
+
+//! Delete a pattern, including its leaves
+static void
+patternDelete (Term t)
+{
+  if (t != NULL)
+    {
+      if (realTermEncrypt (t))
+	{
+	  patternDelete (TermOp (t));
+	  patternDelete (TermKey (t));
+	}
+      else if (realTermTuple (t))
+	{
+	  patternDelete (TermOp1 (t));
+	  patternDelete (TermOp2 (t));
+	}
+      termFree (t);
+    }
+}
+
+//! Forget everything (after each claim)
+static void
+profileReset (void)
+{
+  int i;
+
+  for (i = 0; i < goalsize; i++)
+    {
+      if (goals[i] != NULL)
+	{
+	  patternDelete (goals[i]->pattern);
+	  free (goals[i]);
+	  goals[i] = NULL;
+	}
+    }
+  goalcount = 0;
+  for (i = 0; i < sendcount; i++)
+    {
+      free (sends[i]);
+    }
+  sendcount = 0;
+}
+
+//! Cleanup
+void
+profileDone (void)
+{
+  profileReset ();
+  free (goals);
+  free (sends);
+  profileInit ();
+}
+
+//! Hash of a term, ignoring run identifiers
+static unsigned int
+patternHash (Term t)
+{
+  t = deVar (t);
+  if (t == NULL)
+    {
+      return 0;
+    }
+  if (realTermLeaf (t))
+    {
+      return (unsigned int) ((uintptr_t) TermSymb (t) >> 4) * 31 + t->type;
+    }
+  if (realTermEncrypt (t))
+    {
+      return 3 * patternHash (TermOp (t)) + 7 * patternHash (TermKey (t)) +
+	1 + t->helper.fcall;
+    }
+  return 5 * patternHash (TermOp1 (t)) + 11 * patternHash (TermOp2 (t)) + 3;
+}
+
+//! Check whether a term matches a pattern, ignoring run identifiers
+static int
+patternEqual (Term p, Term t)
+{
+  t = deVar (t);
+  if (p == NULL || t == NULL)
+    {
+      return (p == t);
+    }
+  if (p->type != t->type)
+    {
+      return false;
+    }
+  if (realTermLeaf (t))
+    {
+      return (TermSymb (p) == TermSymb (t));
+    }
+  if (realTermEncrypt (t))
+    {
+      return (p->helper.fcall == t->helper.fcall
+	      && patternEqual (TermOp (p), TermOp (t))
+	      && patternEqual (TermKey (p), TermKey (t)));
+    }
+  return (patternEqual (TermOp1 (p), TermOp1 (t))
+	  && patternEqual (TermOp2 (p), TermOp2 (t)));
+}
+
+//! Copy a term without its run identifiers and substitutions
+static Term
+patternCopy (Term t)
+{
+  Term p;
+
+  t = deVar (t);
+  if (t == NULL)
+    {
+      return NULL;
+    }
+  if (realTermLeaf (t))
+    {
+      return makeTermType (t->type, TermSymb (t), -1);
+    }
+  if (realTermEncrypt (t))
+    {
+      p = makeTermEncrypt (patternCopy (TermOp (t)), patternCopy (TermKey (t)));
+      p->helper.fcall = t->helper.fcall;
+      return p;
+    }
+  return makeTermTuple (patternCopy (TermOp1 (t)), patternCopy (TermOp2 (t)));
+}
+
+//! Slot of a goal pattern
+static int
+goalSlot (const Term goal, const unsigned int hash)
+{
+  int i;
+
+  i = (int) (hash & (goalsize - 1));
+  while (goals[i] != NULL
+	 && !(goals[i]->hash == hash && patternEqual (goals[i]->pattern, goal)))
+    {
+      i = (i + 1) & (goalsize - 1);
+    }
+  return i;
+}
+
+//! Grow the goal table
+static void
+goalsGrow (void)
+{
+  Profilegoal *old;
+  int oldsize;
+  int i;
+
+  old = goals;
+  oldsize = goalsize;
+  goalsize = (oldsize == 0 ? 64 : 2 * oldsize);
+  goals = (Profilegoal *) calloc (goalsize, sizeof (Profilegoal));
+  for (i = 0; i < oldsize; i++)
+    {
+      if (old[i] != NULL)
+	{
+	  goals[goalSlot (old[i]->pattern, old[i]->hash)] = old[i];
+	}
+    }
+  free (old);
+}
+
+//! Mark the start of a subtree
+void
+profileStart (const System sys, struct profilemark *mark)
+{
+  mark->states = sys->states;
+  mark->clock = clock ();
+}
+
+//! Enter the subtrees of a goal
+Profilegoal
+profileGoalEnter (const Term goal)
+{
+  unsigned int hash;
+  int i;
+
+  if (2 * (goalcount + 1) > goalsize)
+    {
+      goalsGrow ();
+    }
+  hash = patternHash (goal);
+  i = goalSlot (goal, hash);
+  if (goals[i] == NULL)
+    {
+      goals[i] = (Profilegoal) calloc (1, sizeof (struct profilegoal));
+      goals[i]->pattern = patternCopy (goal);
+      goals[i]->hash = hash;
+      goalcount++;
+    }
+  goals[i]->active++;
+  return goals[i];
+}
+
+//! Attribute a subtree to a goal and the way it was bound
+void
+profileGoal (const System sys, const Profilegoal g, const int kind,
+	     const struct profilemark *mark)
+{
+  g->tries[kind]++;
+  if (g->active == 1)
+    {
+      g->states[kind] += sys->states - mark->states;
+      g->ticks[kind] += clock () - mark->clock;
+    }
+}
+
+//! Leave the subtrees of a goal
+void
+profileGoalLeave (const Profilegoal g)
+{
+  g->active--;
+}
+
+//! Enter the subtree of a binding to the send event of a role
+Profilesend
+profileSendEnter (const Protocol p, const Role r, const Roledef rd,
+		  const int index)
+{
+  int i;
+
+  for (i = 0; i < sendcount && sends[i]->rd != rd; i++)
+    ;
+  if (i == sendcount)
+    {
+      if (sendcount == sendsize)
+	{
+	  sendsize = (sendsize == 0 ? 16 : 2 * sendsize);
+	  sends = (Profilesend *) realloc (sends,
+					   sendsize * sizeof (Profilesend));
+	}
+      sends[i] = (Profilesend) calloc (1, sizeof (struct profilesend));
+      sends[i]->protocol = p;
+      sends[i]->role = r;
+      sends[i]->rd = rd;
+      sends[i]->index = index;
+      sendcount++;
+    }
+  sends[i]->active++;
+  return sends[i];
+}
+
+//! Attribute the subtree to the send event and leave it
+void
+profileSendLeave (const System sys, const Profilesend ps,
+		  const struct profilemark *mark)
+{
+  ps->tries++;
+  if (ps->active == 1)
+    {
+      ps->states += sys->states - mark->states;
+      ps->ticks += clock () - mark->clock;
+    }
+  ps->active--;
+}
+
+//! Total states below a goal pattern
+static states_t
+goalStates (const struct profilegoal *g)
+{
+  states_t total;
+  int kind;
+
+  total = 0;
+  for (kind = 0; kind < PROFILE_KINDS; kind++)
+    {
+      total += g->states[kind];
+    }
+  return total;
+}
+
+//! Order goal patterns by decreasing states
+static int
+goalCompare (const void *a, const void *b)
+{
+  states_t sa, sb;
+
+  sa = goalStates (*(Profilegoal *) a);
+  sb = goalStates (*(Profilegoal *) b);
+  return (sa < sb) - (sa > sb);
+}
+
+//! Order send events by decreasing states
+static int
+sendCompare (const void *a, const void *b)
+{
+  states_t sa, sb;
+
+  sa = (*(Profilesend *) a)->states;
+  sb = (*(Profilesend *) b)->states;
+  return (sa < sb) - (sa > sb);
+}
+
+//! Seconds of CPU time
+static double
+seconds (const clock_t ticks)
+{
+  return (double) ticks / CLOCKS_PER_SEC;
+}
+
+//! Report the hottest goal patterns and send events of the claim
+/**
+ * Tab separated, like the claim lines of the summary. For the goals, the
+ * number of states is listed for each way of binding them: to a goal that
+ * was bound before, to a regular run, or to an existing or a new intruder
+ * run.
+ */
+void
+profileClaim (const System sys, const Claimlist cl)
+{
+  Profilegoal *sorted;
+  int i, n;
+
+  if (switches.output != SUMMARY)
+    {
+      globalError++;
+    }
+
+  eprintf ("profile\tclaim\t");
+  claimNamePrint (cl);
+  eprintf ("\tstates=");
+  statesFormat (cl->states);
+  eprintf ("\n");
+
+  sorted = (Profilegoal *) malloc ((goalcount + 1) * sizeof (Profilegoal));
+  n = 0;
+  for (i = 0; i < goalsize; i++)
+    {
+      if (goals[i] != NULL)
+	{
+	  sorted[n] = goals[i];
+	  n++;
+	}
+    }
+  qsort (sorted, n, sizeof (Profilegoal), goalCompare);
+  for (i = 0; i < n && i < switches.profile; i++)
+    {
+      Profilegoal g;
+      clock_t ticks;
+      int kind;
+
+      g = sorted[i];
+      ticks = 0;
+      for (kind = 0; kind < PROFILE_KINDS; kind++)
+	{
+	  ticks += g->ticks[kind];
+	}
+      eprintf ("profile\tgoal\tstates=%lu\ttime=%.3f\t", goalStates (g),
+	       seconds (ticks));
+      eprintf ("old-goal=%lu\tregular=%lu\told-intruder=%lu\t",
+	       g->states[PROFILE_OLD_GOAL], g->states[PROFILE_REGULAR],
+	       g->states[PROFILE_OLD_INTRUDER]);
+      // Every selection of a goal ends in one of these two
+      eprintf ("new-intruder=%lu\tselected=%lu\t",
+	       g->states[PROFILE_NEW_INTRUDER],
+	       g->tries[PROFILE_OLD_GOAL] + g->tries[PROFILE_OLD_INTRUDER]);
+      termPrint (g->pattern);
+      eprintf ("\n");
+    }
+  free (sorted);
+
+  if (sendcount > 0)
+    {
+      qsort (sends, sendcount, sizeof (Profilesend), sendCompare);
+    }
+  for (i = 0; i < sendcount && i < switches.profile; i++)
+    {
+      Profilesend s;
+
+      s = sends[i];
+      eprintf ("profile\tsend\tstates=%lu\ttime=%.3f\tbound=%lu\t",
+	       s->states, seconds (s->ticks), s->tries);
+      termPrint (s->protocol->nameterm);
+      eprintf (",");
+      termPrint (s->role->nameterm);
+      eprintf ("\t%i\t", s->index);
+      roledefPrint (s->rd);
+      eprintf ("\n");
+    }
+
+  if (switches.output != SUMMARY)
+    {
+      globalError--;
+    }
+  profileReset ();
+}
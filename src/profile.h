@@ -0,0 +1,59 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROFILE
+#define PROFILE
+
+#include <time.h>
+
+#include "system.h"
+#include "claim.h"
+
+//! Ways of binding a goal, as tried by bind_goal_all_options
+enum profilekinds
+{ PROFILE_OLD_GOAL, PROFILE_REGULAR, PROFILE_OLD_INTRUDER,
+  PROFILE_NEW_INTRUDER, PROFILE_KINDS
+};
+
+//! Start of a subtree of the proof tree
+struct profilemark
+{
+  states_t states;		//!< sys->states when the subtree was entered
+  clock_t clock;		//!< CPU time when the subtree was entered
+};
+
+//! Pointer shorthands
+typedef struct profilegoal *Profilegoal;
+typedef struct profilesend *Profilesend;
+
+void profileInit (void);
+void profileDone (void);
+
+void profileStart (const System sys, struct profilemark *mark);
+Profilegoal profileGoalEnter (const Term goal);
+void profileGoal (const System sys, const Profilegoal g, const int kind,
+		  const struct profilemark *mark);
+void profileGoalLeave (const Profilegoal g);
+Profilesend profileSendEnter (const Protocol p, const Role r,
+			      const Roledef rd, const int index);
+void profileSendLeave (const System sys, const Profilesend ps,
+		       const struct profilemark *mark);
+void profileClaim (const System sys, const Claimlist cl);
+
+#endif
@@ -0,0 +1,410 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file progress.c
+ * \brief Progress reports during the test of a claim
+ *
+ * For claims that take long, a line with the state of the search is written
+ * every --progress=<int> seconds, and whenever the process receives SIGUSR1.
+ * It goes to stderr, or replaces the contents of the --progress-file.
+ *
+ * The signal handlers only set a flag, which is checked for every state, so
+ * the report is written from the search itself.
+ *
+ * The estimate of the remaining work is based on the top levels of the proof
+ * tree. Every goal has a branch for each send of a regular role, plus the
+ * existing and new intruder runs. We keep track of the branch that is being
+ * explored at each of the top levels, which gives the fraction of the tree
+ * that is done, assuming all branches are equally large. That is rarely
+ * true, so it is no more than an indication.
+ */
+
+/* setitimer, sigaction and gettimeofday are not part of C11 */
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+
+#include "progress.h"
+#include "switches.h"
+#include "symbol.h"
+#include "error.h"
+#include "cache.h"
+
+#ifdef PROGRESS_SIGNAL
+#include <sys/time.h>
+#else
+#define PROGRESS_CHECK_CALLS 1024
+#endif
+
+//! Number of top levels of the proof tree used for the estimate
+#define PROGRESS_LEVELS 2
+
+extern Protocol INTRUDER;
+extern int proofDepth;
+extern int attack_leastcost;
+
+volatile sig_atomic_t progress_due = 0;	//!< Set when a report is due
+
+static Roledef *sends = NULL;	//!< Sends of the regular roles, in order
+static int nsends = 0;		//!< Number of sends
+static Claimlist claim = NULL;	//!< Claim under test
+static double claim_start;	//!< Start of the claim test, in seconds
+static int depth_max;		//!< Maximum proof depth for the claim
+static int branches[PROGRESS_LEVELS];	//!< Branches of the goal at a level
+static int branch[PROGRESS_LEVELS];	//!< Branch explored at a level
+
+#ifndef PROGRESS_SIGNAL
+static int check_countdown = 0;
+static double last_report = 0;
+#endif
+
+//! Current time in seconds
+/**
+ * Wall clock time where we have it, otherwise CPU time.
+ */
+static double
+progressNow (void)
+{
+#ifdef PROGRESS_SIGNAL
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return (double) tv.tv_sec + (double) tv.tv_usec / 1000000.0;
+#else
+  return (double) clock () / CLOCKS_PER_SEC;
+#endif
+}
+
+#ifdef PROGRESS_SIGNAL
+//! SIGUSR1 or the periodic timer
+static void
+progress_handler (int signum)
+{
+  progress_due = 1;
+}
+
+//! Install a handler for a signal
+static void
+progress_signal (int signum)
+{
+  struct sigaction sa;
+
+  sa.sa_handler = progress_handler;
+  sigemptyset (&sa.sa_mask);
+  // Do not break any I/O we are doing at the time
+  sa.sa_flags = SA_RESTART;
+  if (sigaction (signum, &sa, NULL) != 0)
+    {
+      error ("Could not install the progress signal handler.");
+    }
+}
+#endif
+
+//! Set up the progress reports
+/**
+ * Called after the intruder protocol has been added.
+ */
+void
+progressInit (const System sys)
+{
+  Protocol p;
+  int i;
+
+  nsends = 0;
+  for (i = 0; i < 2; i++)
+    {
+      for (p = sys->protocols; p != NULL; p = p->next)
+	{
+	  Role r;
+
+	  if (p == INTRUDER)
+	    {
+	      continue;
+	    }
+	  for (r = p->roles; r != NULL; r = r->next)
+	    {
+	      Roledef rd;
+
+	      for (rd = r->roledef; rd != NULL; rd = rd->next)
+		{
+		  if (rd->type == SEND)
+		    {
+		      if (sends != NULL)
+			{
+			  sends[nsends] = rd;
+			}
+		      nsends++;
+		    }
+		}
+	    }
+	}
+      if (i == 0)
+	{
+	  sends = (Roledef *) malloc ((nsends + 1) * sizeof (Roledef));
+	  nsends = 0;
+	}
+    }
+
+#ifdef PROGRESS_SIGNAL
+  progress_signal (SIGUSR1);
+  if (switches.progress > 0)
+    {
+      struct itimerval it;
+
+      progress_signal (SIGALRM);
+      it.it_interval.tv_sec = switches.progress;
+      it.it_interval.tv_usec = 0;
+      it.it_value = it.it_interval;
+      if (setitimer (ITIMER_REAL, &it, NULL) != 0)
+	{
+	  error ("Could not start the progress timer.");
+	}
+    }
+#endif
+}
+
+//! Stop the progress reports
+void
+progressDone (void)
+{
+#ifdef PROGRESS_SIGNAL
+  if (switches.progress > 0)
+    {
+      struct itimerval it;
+
+      it.it_interval.tv_sec = 0;
+      it.it_interval.tv_usec = 0;
+      it.it_value = it.it_interval;
+      setitimer (ITIMER_REAL, &it, NULL);
+    }
+#endif
+  free (sends);
+  sends = NULL;
+  nsends = 0;
+  claim = NULL;
+}
+
+//! Start of the test of a claim
+void
+progressClaim (const Claimlist cl)
+{
+  int l;
+
+  claim = cl;
+  claim_start = progressNow ();
+  depth_max = 0;
+  for (l = 0; l < PROGRESS_LEVELS; l++)
+    {
+      branches[l] = 1;
+      branch[l] = 0;
+    }
+}
+
+//! A goal is bound at the current proof depth
+/**
+ * A goal that can only be known to the intruder has a single branch.
+ */
+void
+progressGoal (const int know_only)
+{
+  int l;
+
+  if (proofDepth > depth_max)
+    {
+      depth_max = proofDepth;
+    }
+  l = proofDepth - 1;
+  if (l >= 0 && l < PROGRESS_LEVELS)
+    {
+      branches[l] = (know_only ? 1 : nsends + 2);
+      branch[l] = 0;
+    }
+}
+
+//! The goal at the current proof depth is bound to a send of a regular role
+void
+progressSend (const Roledef rd)
+{
+  int l;
+
+  l = proofDepth - 1;
+  if (l >= 0 && l < PROGRESS_LEVELS && branches[l] > 1)
+    {
+      int i;
+
+      for (i = 0; i < nsends; i++)
+	{
+	  if (sends[i] == rd)
+	    {
+	      branch[l] = i;
+	      return;
+	    }
+	}
+    }
+}
+
+//! The goal at the current proof depth is bound to an intruder run
+/**
+ * Either an existing one or a new (fresh) one.
+ */
+void
+progressIntruder (const int fresh)
+{
+  int l;
+
+  l = proofDepth - 1;
+  if (l >= 0 && l < PROGRESS_LEVELS && branches[l] > 1)
+    {
+      branch[l] = nsends + (fresh ? 1 : 0);
+    }
+}
+
+//! Fraction of the proof tree of the claim that is done
+static double
+progressFraction (void)
+{
+  double done, width;
+  int l;
+
+  done = 0;
+  width = 1;
+  for (l = 0; l < PROGRESS_LEVELS && l < proofDepth; l++)
+    {
+      width = width / branches[l];
+      done = done + branch[l] * width;
+    }
+  return done;
+}
+
+//! Write the progress line
+static void
+progressLine (const System sys)
+{
+  double elapsed, done;
+
+  elapsed = progressNow () - claim_start;
+  done = progressFraction ();
+  eprintf ("progress\t");
+  claimNamePrint (claim);
+  eprintf ("\tstates=");
+  statesFormat (claim->states);
+  eprintf ("\trate=%.0f/s",
+	   (elapsed > 0 ? (double) claim->states / elapsed : 0.0));
+  eprintf ("\tdepth=%i\tmaxdepth=%i", proofDepth, depth_max);
+  eprintf ("\truns=%i", sys->maxruns);
+  if (attack_leastcost == INT_MAX)
+    {
+      eprintf ("\tleastcost=-");
+    }
+  else
+    {
+      eprintf ("\tleastcost=%i", attack_leastcost);
+    }
+  eprintf ("\tdone=%.1f%%", 100 * done);
+  if (done > 0)
+    {
+      eprintf ("\tremaining=%.0fs", elapsed / done - elapsed);
+    }
+  else
+    {
+      eprintf ("\tremaining=-");
+    }
+  eprintf ("\n");
+}
+
+//! Report the progress of the claim test
+/**
+ * To stderr, or to the progress file, which is rewritten every time.
+ */
+void
+progressReport (const System sys)
+{
+  int capturing;
+
+  progress_due = 0;
+#ifndef PROGRESS_SIGNAL
+  last_report = progressNow ();
+#endif
+  if (claim == NULL)
+    {
+      return;
+    }
+  // Not part of the result of the claim
+  capturing = cache_capturing;
+  cache_capturing = false;
+  if (switches.progressFile != NULL)
+    {
+      FILE *fp;
+      char *oldstream;
+      int olderror;
+
+      fp = fopen (switches.progressFile, "w");
+      if (fp == NULL)
+	{
+	  warning ("Could not write progress file %s.",
+		   switches.progressFile);
+	  cache_capturing = capturing;
+	  return;
+	}
+      oldstream = globalStream;
+      olderror = globalError;
+      globalStream = (char *) fp;
+      globalError = 0;
+      progressLine (sys);
+      globalStream = oldstream;
+      globalError = olderror;
+      fclose (fp);
+    }
+  else
+    {
+      globalError++;
+      progressLine (sys);
+      globalError--;
+      fflush (stderr);
+    }
+  cache_capturing = capturing;
+}
+
+//! Check whether a report is due without signals
+/**
+ * Looks at the clock every PROGRESS_CHECK_CALLS calls only.
+ */
+int
+progressPoll (void)
+{
+#ifndef PROGRESS_SIGNAL
+  if (switches.progress > 0)
+    {
+      check_countdown--;
+      if (check_countdown <= 0)
+	{
+	  check_countdown = PROGRESS_CHECK_CALLS;
+	  if (progressNow () - last_report >= switches.progress)
+	    {
+	      return true;
+	    }
+	}
+    }
+#endif
+  return false;
+}
@@ -0,0 +1,52 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROGRESS
+#define PROGRESS
+
+#include <signal.h>
+
+#include "system.h"
+#include "claim.h"
+
+#if defined(linux) || defined(__linux__) || defined(__APPLE__)
+#define PROGRESS_SIGNAL
+#endif
+
+extern volatile sig_atomic_t progress_due;
+
+void progressInit (const System sys);
+void progressDone (void);
+void progressClaim (const Claimlist cl);
+void progressGoal (const int know_only);
+void progressSend (const Roledef rd);
+void progressIntruder (const int fresh);
+void progressReport (const System sys);
+int progressPoll (void);
+
+//! Report the progress if it is due; called for every state
+#ifdef PROGRESS_SIGNAL
+#define progressCheck(sys) \
+  if (progress_due) progressReport (sys)
+#else
+#define progressCheck(sys) \
+  if (progressPoll ()) progressReport (sys)
+#endif
+
+#endif
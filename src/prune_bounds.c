@@ -35,6 +35,8 @@
 #include "system.h"
 #include "termmap.h"
 #include "cost.h"
+#include "restart.h"
+#include "stats.h"
 
 extern int attack_length;
 extern int attack_leastcost;
@@ -66,6 +68,50 @@ prune_bounds (const System sys)
 	}
       // Pruned because of time bound!
       sys->current_claim->timebound = 1;
+      stats.prunes[PRUNE_TIME]++;
+      return 1;
+    }
+
+  /* prune for states; unlike time, this does not depend on the machine */
+  if (switches.maxStates > 0
+      && sys->current_claim->states >= switches.maxStates)
+    {
+      if (switches.output == PROOF)
+	{
+	  indentPrint ();
+	  eprintf ("Pruned: reached the maximum number of states (--max-states ");
+	  statesFormat (switches.maxStates);
+	  eprintf (")\n");
+	}
+      sys->current_claim->statebound = 1;
+      stats.prunes[PRUNE_MAX_STATES]++;
+      return 1;
+    }
+
+  /* prune for memory */
+  if (passed_memory_limit ())
+    {
+      if (switches.output == PROOF)
+	{
+	  indentPrint ();
+	  eprintf ("Pruned: ran out of allowed memory (--max-memory %i MB)\n",
+		   get_memory_limit ());
+	}
+      // Pruned because of memory bound!
+      sys->current_claim->membound = 1;
+      stats.prunes[PRUNE_MEMORY]++;
+      return 1;
+    }
+
+  /* prune for the budget of a randomized restart */
+  if (restartBudgetExhausted (sys->current_claim->states))
+    {
+      if (switches.output == PROOF)
+	{
+	  indentPrint ();
+	  eprintf ("Pruned: restart budget exhausted.\n");
+	}
+      stats.prunes[PRUNE_RESTART]++;
       return 1;
     }
 
@@ -79,6 +125,7 @@ prune_bounds (const System sys)
 	  eprintf
 	    ("Pruned: we already found the maximum number of attacks.\n");
 	}
+      stats.prunes[PRUNE_MAX_ATTACKS]++;
       return 1;
     }
 
@@ -92,6 +139,7 @@ prune_bounds (const System sys)
 	  eprintf ("Pruned: proof tree too deep: %i (-d %i switch)\n",
 		   proofDepth, switches.maxproofdepth);
 	}
+      stats.prunes[PRUNE_PROOF_DEPTH]++;
       return 1;
     }
 
@@ -99,20 +147,9 @@ prune_bounds (const System sys)
   if (switches.maxtracelength < INT_MAX)
     {
       int tracelength;
-      int run;
 
-      /* compute trace length of current semistate */
-      tracelength = 0;
-      run = 0;
-      while (run < sys->maxruns)
-	{
-	  /* ignore intruder actions */
-	  if (sys->runs[run].protocol != INTRUDER)
-	    {
-	      tracelength = tracelength + sys->runs[run].step;
-	    }
-	  run++;
-	}
+      /* steps of the regular runs, kept up to date by setRunHeight */
+      tracelength = sys->regular_steps;
       /* test */
       if (tracelength > switches.maxtracelength)
 	{
@@ -123,6 +160,7 @@ prune_bounds (const System sys)
 	      eprintf ("Pruned: trace too long: %i (-l %i switch)\n",
 		       tracelength, switches.maxtracelength);
 	    }
+	  stats.prunes[PRUNE_TRACE_LENGTH]++;
 	  return 1;
 	}
     }
@@ -137,17 +175,19 @@ prune_bounds (const System sys)
 	  eprintf ("Pruned: too many regular runs (%i).\n",
 		   sys->num_regular_runs);
 	}
+      stats.prunes[PRUNE_RUNS]++;
       return 1;
     }
 
-  /* prune for role instances max */
-  if (tooManyOfRole (sys))
+  /* prune for role instances max (no role can exceed it with fewer runs) */
+  if (sys->num_regular_runs > switches.maxOfRole && tooManyOfRole (sys))
     {
       if (switches.output == PROOF)
 	{
 	  indentPrint ();
 	  eprintf ("Pruned: too many instances of a particular role.\n");
 	}
+      stats.prunes[PRUNE_ROLE_INSTANCES]++;
       return 1;
     }
 
@@ -170,6 +210,7 @@ prune_bounds (const System sys)
 		("Pruned: %i intruder runs is too much. (max encr. level %i)\n",
 		 sys->num_intruder_runs, max_encryption_level);
 	    }
+	  stats.prunes[PRUNE_INTRUDER_RUNS]++;
 	  return 1;
 	}
     }
@@ -182,11 +223,12 @@ prune_bounds (const System sys)
 	  indentPrint ();
 	  eprintf ("Pruned: attack length %i.\n", attack_length);
 	}
+      stats.prunes[PRUNE_ATTACK_LENGTH]++;
       return 1;
     }
 
   /* prune for cheaper */
-  if (switches.prune != 0 && attack_leastcost <= attackCost (sys))
+  if (switches.prune != 0 && attackCostReaches (sys, attack_leastcost))
     {
       // We already had an attack at least this cheap.
       if (switches.output == PROOF)
@@ -195,6 +237,7 @@ prune_bounds (const System sys)
 	  eprintf
 	    ("Pruned: attack cost exceeds a previously found attack.\n");
 	}
+      stats.prunes[PRUNE_ATTACK_COST]++;
       return 1;
     }
 
@@ -217,6 +260,7 @@ prune_bounds (const System sys)
 		  ("Pruned: no intruder allowed.\n",
 		   switches.maxIntruderActions);
 	      }
+	    stats.prunes[PRUNE_NO_INTRUDER]++;
 	    return 1;
 	  }
       }
@@ -231,6 +275,7 @@ prune_bounds (const System sys)
 	      ("Pruned: more than %i encrypt/decrypt events in the semitrace.\n",
 	       switches.maxIntruderActions);
 	  }
+	stats.prunes[PRUNE_INTRUDER_ACTIONS]++;
 	return 1;
       }
   }
@@ -35,6 +35,7 @@
 #include "depend.h"
 #include "arachne.h"
 #include "error.h"
+#include "stats.h"
 #include "type.h"
 
 extern Protocol INTRUDER;
@@ -313,6 +314,7 @@ prune_theorems (const System sys)
 	  eprintf
 	    ("Pruned because some local variable was incorrectly substituted.\n");
 	}
+      stats.prunes[PRUNE_SUBSTITUTION]++;
       return true;
     }
 
@@ -327,6 +329,7 @@ prune_theorems (const System sys)
 	      eprintf
 		("Pruned because an agent may not perform multiple roles.\n");
 	    }
+	  stats.prunes[PRUNE_MULTIPLE_ROLES]++;
 	  return true;
 	}
     }
@@ -345,6 +348,7 @@ prune_theorems (const System sys)
 	  // Still need to fix proof output for this
 	  //
 	  // Pruning because some agents are equal for this role.
+	  stats.prunes[PRUNE_SELF_INITIATOR]++;
 	  return true;
 	}
     }
@@ -357,6 +361,7 @@ prune_theorems (const System sys)
 	  // Still need to fix proof output for this
 	  //
 	  // Pruning because some agents are equal for this role.
+	  stats.prunes[PRUNE_SELF_RESPONDER]++;
 	  return true;
 	}
     }
@@ -371,6 +376,7 @@ prune_theorems (const System sys)
 	      eprintf
 		("Pruned because agents are not performing unique roles.\n");
 	    }
+	  stats.prunes[PRUNE_UNIQUE_ROLES]++;
 	  return true;
 	}
     }
@@ -402,6 +408,7 @@ so technically this is a bug. Don't use.
 		      eprintf (" of run %i is not of a compatible type.\n",
 			       run);
 		    }
+		  stats.prunes[PRUNE_AGENT_TYPE]++;
 		  return true;
 		}
 	    }
@@ -417,6 +424,7 @@ so technically this is a bug. Don't use.
 	      eprintf
 		("Pruned: an initiator role does not have the correct type for one of its agents.\n");
 	    }
+	  stats.prunes[PRUNE_AGENT_TYPE]++;
 	  return true;
 	}
 
@@ -432,6 +440,7 @@ so technically this is a bug. Don't use.
 	      eprintf
 		("Pruned: some run does not have the correct type for one of its agents.\n");
 	    }
+	  stats.prunes[PRUNE_AGENT_TYPE]++;
 	  return true;
 	}
     }
@@ -464,6 +473,7 @@ so technically this is a bug. Don't use.
 			    ("Pruned because the actor of run %i is untrusted.\n",
 			     run);
 			}
+		      stats.prunes[PRUNE_UNTRUSTED]++;
 		      return true;
 		    }
 		}
@@ -497,6 +507,7 @@ so technically this is a bug. Don't use.
 	    indentPrint ();
 	    eprintf ("Pruned because the pattern is redundant.\n");
 	  }
+	stats.prunes[PRUNE_REDUNDANT]++;
 	return true;
       }
   }
@@ -505,6 +516,7 @@ so technically this is a bug. Don't use.
   if (!inequalityConstraints (sys))
     {
       // Prune, because violated
+      stats.prunes[PRUNE_INEQUALITY]++;
       return true;
     }
 
@@ -523,6 +535,7 @@ so technically this is a bug. Don't use.
 	      eprintf
 		("Pruned because this does not have the correct local order.\n");
 	    }
+	  stats.prunes[PRUNE_LOCAL_ORDER]++;
 	  return true;
 	}
     }
@@ -549,6 +562,7 @@ so technically this is a bug. Don't use.
 	      termPrint (b->term);
 	      eprintf ("\n");
 	    }
+	  stats.prunes[PRUNE_HIDDEN]++;
 	  return true;
 	}
 
@@ -570,6 +584,7 @@ so technically this is a bug. Don't use.
 		      termPrint (b->term);
 		      eprintf (" is not known initially to the intruder.\n");
 		    }
+		  stats.prunes[PRUNE_FUNCTION]++;
 		  return true;
 		}
 	    }
@@ -594,6 +609,7 @@ so technically this is a bug. Don't use.
 		      termPrint (b->term);
 		      eprintf (" is too high.\n");
 		    }
+		  stats.prunes[PRUNE_ENCRYPTION_LEVEL]++;
 		  return true;
 		}
 	    }
@@ -617,6 +633,7 @@ so technically this is a bug. Don't use.
 	      termPrint (b->term);
 	      eprintf (" is too high.\n");
 	    }
+	  stats.prunes[PRUNE_ENCRYPTION_LEVEL]++;
 	  return true;
 	}
 
@@ -633,6 +650,7 @@ so technically this is a bug. Don't use.
 	      termPrint (b->term);
 	      eprintf (" is impossible to satisfy.\n");
 	    }
+	  stats.prunes[PRUNE_HIDELEVEL]++;
 	  return true;
 	}
 
@@ -667,6 +685,7 @@ so technically this is a bug. Don't use.
 		      termPrint (rolename);
 		      eprintf (" occurs more than once in the semitrace.\n");
 		    }
+		  stats.prunes[PRUNE_SINGULAR]++;
 		  return true;
 		}
 	      run2++;
@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""
+Scyther : An automatic verifier for security protocols.
+Copyright (C) 2007-2025 Cas Cremers
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+"""
+
+"""
+Performance benchmark for changes to the Scyther executable.
+
+Runs the argument lines in "bench.txt" (a pinned set of protocols with fixed
+bounds), records the wall time, the number of states per claim, the peak
+resident set size and the allocation counters of each run into a JSON
+report, and compares the report against a checked-in baseline.
+
+The backend is run with --json-output; the states come from the claim
+records and the allocation counters from the final totals record.
+
+Example:
+
+    ./bench.py --repeat=3 --time-threshold=0.5
+"""
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import time
+
+from importlib import import_module
+
+regressiontest = import_module("regression-test")
+
+# Allocation counters, from the totals record of the backend
+ALLOCATIONS = ["runchanges", "runallocations", "dependgraphs",
+               "dependallocations", "terms", "termlists"]
+
+
+def readBench(fn):
+    """ Argument lines from a bench file, with the global settings applied """
+    res = []
+    setting = ""
+    for l in open(fn, 'r'):
+        if l.startswith("#") or l.startswith("%"):
+            continue
+        d = l.strip()
+        if len(d) == 0:
+            continue
+        if d.startswith("="):
+            setting = d[1:].strip()
+        else:
+            res.append((d, setting))
+    return res
+
+
+def termNames(lines):
+    """
+    Names of the terms in JSON lines output.
+
+    Only leaves have a proper name; a tuple is named after its last element,
+    which turns a claim label (protocol,label) into just the label.
+    """
+    names = {}
+    for rec in lines:
+        if "term" in rec:
+            if "const" in rec:
+                names[rec["term"]] = rec["const"]
+            elif "var" in rec:
+                names[rec["term"]] = rec["var"]
+            elif "tuple" in rec:
+                names[rec["term"]] = names.get(rec["tuple"][1])
+    return names
+
+
+def runOnce(opts, line, setting):
+    """
+    Run the backend once and return (seconds, maxrss, records).
+
+    The peak resident set size is in kilobytes. It is taken from the
+    totals record if the backend reports it; the rusage figure of the child
+    also includes our own memory from before it was executed.
+    """
+    args = [opts.scyther] + line.split() + setting.split() + \
+        ["--json-output"]
+    args[1] = os.path.join(opts.root, args[1])
+
+    start = time.time()
+    proc = subprocess.Popen(args, stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL,
+                            universal_newlines=True)
+    output = proc.stdout.read()
+    proc.stdout.close()
+    maxrss = None
+    if hasattr(os, "wait4"):
+        (pid, status, usage) = os.wait4(proc.pid, 0)
+        proc.returncode = status
+        maxrss = usage.ru_maxrss
+    else:
+        proc.wait()
+    seconds = time.time() - start
+
+    records = []
+    for l in output.splitlines():
+        if l.startswith("{"):
+            rec = json.loads(l)
+            if "totals" in rec and "maxrss" in rec["totals"]:
+                maxrss = rec["totals"]["maxrss"]
+            records.append(rec)
+    return (seconds, maxrss, records)
+
+
+def runBench(opts, line, setting):
+    """ Run a benchmark line and return its report entry """
+    best = None
+    for i in range(opts.repeat):
+        (seconds, maxrss, records) = runOnce(opts, line, setting)
+        if best is None or seconds < best[0]:
+            best = (seconds, maxrss, records)
+    (seconds, maxrss, records) = best
+
+    names = termNames(records)
+    claims = {}
+    totals = {}
+    for rec in records:
+        if "claim" in rec and "states" in rec:
+            # As in the summary: protocol,role Type_label
+            key = "%s,%s %s_%s" % (rec["protocol"], rec["role"],
+                                   names.get(rec["claim"]),
+                                   names.get(rec["label"]))
+            claims[key] = rec["states"]
+        elif "totals" in rec:
+            totals = rec["totals"]
+
+    entry = {"args": "%s %s" % (line, setting),
+             "seconds": round(seconds, 3),
+             "maxrss": maxrss,
+             "states": sum(claims.values()),
+             "claims": claims,
+             "allocations": {}}
+    for k in ALLOCATIONS:
+        if k in totals:
+            entry["allocations"][k] = totals[k]
+    return entry
+
+
+def regressions(opts, baseline, report):
+    """ List of regressions of the report with respect to the baseline """
+    res = []
+
+    def check(name, metric, old, new, threshold, slack=0):
+        if old is None or new is None:
+            return
+        if new > old * (1 + threshold) + slack:
+            res.append("%s: %s %s -> %s" % (name, metric, old, new))
+
+    for (name, new) in report["benchmarks"].items():
+        if name not in baseline["benchmarks"]:
+            continue
+        old = baseline["benchmarks"][name]
+        check(name, "seconds", old["seconds"], new["seconds"],
+              opts.time_threshold, opts.time_slack)
+        check(name, "maxrss", old["maxrss"], new["maxrss"],
+              opts.rss_threshold)
+        for (claim, states) in new["claims"].items():
+            check(name, "states of %s" % claim, old["claims"].get(claim),
+                  states, opts.states_threshold)
+        if set(old["claims"]) != set(new["claims"]):
+            res.append("%s: different claims" % (name))
+        for k in ALLOCATIONS:
+            check(name, k, old["allocations"].get(k),
+                  new["allocations"].get(k), opts.allocation_threshold)
+    return res
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--scyther",
+                        default=os.path.join(here, "..", "scyther-linux"),
+                        help="backend binary [%(default)s]")
+    parser.add_argument("--root",
+                        default=os.path.dirname(os.path.dirname(here)),
+                        help="repository root with the protocols")
+    parser.add_argument("--bench", default=os.path.join(here, "bench.txt"),
+                        help="argument lines to run [%(default)s]")
+    parser.add_argument("--baseline",
+                        default=os.path.join(here, "bench-baseline.json"),
+                        help="baseline report [%(default)s]")
+    parser.add_argument("--report", default="bench-report.json",
+                        help="report to write [%(default)s]")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="write the report to the baseline instead")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="runs per line; the fastest is kept")
+    parser.add_argument("--time-threshold", type=float, default=0.25,
+                        help="allowed relative increase [%(default)s]")
+    parser.add_argument("--time-slack", type=float, default=0.05,
+                        help="allowed absolute increase in seconds "
+                        "[%(default)s]")
+    parser.add_argument("--rss-threshold", type=float, default=0.25,
+                        help="allowed relative increase [%(default)s]")
+    parser.add_argument("--states-threshold", type=float, default=0.0,
+                        help="allowed relative increase [%(default)s]")
+    parser.add_argument("--allocation-threshold", type=float, default=0.1,
+                        help="allowed relative increase [%(default)s]")
+    opts = parser.parse_args()
+
+    tests = readBench(opts.bench)
+    print("Running %i benchmarks." % (len(tests)))
+    report = {"scyther": os.path.basename(opts.scyther),
+              "platform": platform.platform(),
+              "date": time.strftime("%Y-%m-%d %H:%M:%S"),
+              "repeat": opts.repeat,
+              "benchmarks": {}}
+    cnt = 1
+    for (line, setting) in tests:
+        name = regressiontest.sanitize(line + " " + setting)
+        entry = runBench(opts, line, setting)
+        report["benchmarks"][name] = entry
+        print("%i/%i: %-50s %8.3fs %8i states %8s kB" %
+              (cnt, len(tests), name, entry["seconds"], entry["states"],
+               entry["maxrss"]))
+        sys.stdout.flush()
+        cnt = cnt + 1
+
+    if opts.update_baseline:
+        opts.report = opts.baseline
+    fp = open(opts.report, 'w')
+    json.dump(report, fp, indent=1, sort_keys=True)
+    fp.write("\n")
+    fp.close()
+    print("Wrote %s" % (opts.report))
+    if opts.update_baseline or not os.path.exists(opts.baseline):
+        return 0
+
+    baseline = json.load(open(opts.baseline, 'r'))
+    res = regressions(opts, baseline, report)
+    if len(res) == 0:
+        print("No regressions with respect to %s" % (opts.baseline))
+        return 0
+    print("%i regressions with respect to %s:" % (len(res), opts.baseline))
+    for r in res:
+        print("  %s" % (r))
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,132 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file restart.c
+ * \brief Randomized restarts for the Arachne engine
+ *
+ * A claim can be tried a number of times with a state budget and random
+ * tie-breaking, before the final (deterministic, unbudgeted) search. The
+ * budgets follow the Luby sequence or grow geometrically, both in units of
+ * --restart-base states.
+ */
+
+#include <limits.h>
+
+#include "restart.h"
+#include "switches.h"
+
+//! True during a randomized attempt
+int restart_randomize = false;
+
+//! State count at which the current attempt is cut off (0 means none)
+static states_t restart_limit = 0;
+//! Whether the current attempt hit its budget
+static int restart_exhausted = false;
+//! Random generator state (xorshift), as set by restartSeed (0)
+static unsigned int restart_rng = 1;
+
+//! Seed the random generator
+void
+restartSeed (const unsigned int seed)
+{
+  restart_rng = seed * 2654435761u + 1;
+  if (restart_rng == 0)
+    {
+      restart_rng = 1;
+    }
+}
+
+//! Random integer in [0,n)
+/**
+ * We use our own generator, such that the --heuristic=-1 stream (rand)
+ * is not influenced.
+ */
+int
+restartRandom (const int n)
+{
+  restart_rng ^= restart_rng << 13;
+  restart_rng ^= restart_rng >> 17;
+  restart_rng ^= restart_rng << 5;
+  return (int) (restart_rng % (unsigned int) n);
+}
+
+//! Luby sequence 1,1,2,1,1,2,4,1,1,2,... (i >= 1)
+static int
+luby (const int i)
+{
+  int k;
+
+  k = 1;
+  while ((1 << k) - 1 < i)
+    {
+      k++;
+    }
+  if ((1 << k) - 1 == i)
+    {
+      return 1 << (k - 1);
+    }
+  return luby (i - (1 << (k - 1)) + 1);
+}
+
+//! Start a restart attempt (from 1)
+/**
+ * The budget is relative to the states counted so far for this claim.
+ */
+void
+restartBegin (const int attempt, const states_t states)
+{
+  states_t budget;
+
+  if (switches.restartSchedule == RESTART_GEOMETRIC)
+    {
+      budget = (attempt < 31) ? (1ul << (attempt - 1)) : (1ul << 30);
+    }
+  else
+    {
+      budget = luby (attempt);
+    }
+  restart_limit = states + budget * (states_t) switches.restartBase;
+  restart_exhausted = false;
+  restart_randomize = true;
+}
+
+//! End a restart attempt
+/**
+ *@returns true iff the attempt was cut off by its budget
+ */
+int
+restartEnd (void)
+{
+  restart_limit = 0;
+  restart_randomize = false;
+  return restart_exhausted;
+}
+
+//! Check the budget of the current attempt (for prune_bounds)
+int
+restartBudgetExhausted (const states_t states)
+{
+  if (restart_limit > 0 && states >= restart_limit)
+    {
+      restart_exhausted = true;
+      return true;
+    }
+  return false;
+}
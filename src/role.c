@@ -249,6 +249,8 @@ roleCreate (Term name)
   r->declaredconsts = NULL;
   r->initiator = 1;		//! Will be determined later, if a recv is the first action (in compiler.c)
   r->singular = false;		// by default, a role is not singular
+  r->runtemplate = NULL;
+  r->created = 0;
   r->next = NULL;
   r->knows = NULL;
   r->lineno = 0;
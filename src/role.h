@@ -60,6 +60,10 @@ struct claimlist
   int complete;
   //! If we ran into the time bound (incomplete, and bad for results)
   int timebound;
+  //! If we ran into the memory bound (idem)
+  int membound;
+  //! If we ran into the --max-states bound (idem, but reproducible)
+  int statebound;
   //! Some claims are always true (shown by the initial scan)
   int alwaystrue;
   //! Warnings should tell you more
@@ -162,6 +166,10 @@ struct role
   int initiator;
   //! Flag for singular roles
   int singular;
+  //! Precompiled run template, built on first instantiation (system.c)
+  struct runtemplate *runtemplate;
+  //! Number of runs of this role created by the search (for --stats)
+  states_t created;
   //! Pointer to next role definition.
   struct role *next;
   //! Line number
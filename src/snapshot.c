@@ -0,0 +1,384 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file snapshot.c
+ * \brief Compact copies of a semitrace
+ *
+ * When only the cheapest attack is reported, every attack found during the
+ * search used to be rendered in full and then thrown away when a cheaper
+ * one came along. Instead, we copy just what the output code reads (the
+ * runs with their events and substitutions, the bindings, the dependency
+ * graph and a few counters) and render only the snapshot that is left at
+ * the end.
+ *
+ * A snapshot is rendered by temporarily installing it into the system in
+ * place of the current semitrace.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "snapshot.h"
+#include "binding.h"
+#include "depend.h"
+#include "list.h"
+#include "term.h"
+#include "termlist.h"
+#include "mymalloc.h"
+
+//! Semitrace copy
+struct snapshot
+{
+  Run runs;			//!< Copies of the runs
+  int maxruns;			//!< Number of runs
+  List bindings;		//!< Copies of the bindings
+  Depsnapshot depend;		//!< Copy of the dependency graph
+
+  /* counters of the system at the time of the snapshot */
+  int attackid;
+  int num_regular_runs;
+  int num_intruder_runs;
+  int num_initiator_runs;
+  int num_intruder_actions;
+  int num_bindings_done;
+  int semitrace_length;
+
+  /* copied terms: open addressing from original to copy */
+  Term *from;			//!< Original terms (NULL for a free slot)
+  Term *to;			//!< Their copies
+  int size;			//!< Number of slots (power of two)
+  int count;			//!< Number of used slots
+
+  /* saved by snapshotInstall */
+  int saved_capacity;
+};
+
+//! Slot of a term in the copy table
+static int
+snapshotSlot (const Snapshot snap, const Term t)
+{
+  uintptr_t h;
+  int i;
+
+  h = ((uintptr_t) t >> 4) * 2654435761u;
+  i = (int) (h & (snap->size - 1));
+  while (snap->from[i] != NULL && snap->from[i] != t)
+    {
+      i = (i + 1) & (snap->size - 1);
+    }
+  return i;
+}
+
+//! Grow the copy table
+static void
+snapshotGrow (const Snapshot snap)
+{
+  Term *from, *to;
+  int size, i;
+
+  from = snap->from;
+  to = snap->to;
+  size = snap->size;
+  snap->size = (size == 0 ? 256 : 2 * size);
+  snap->from = (Term *) malloc (snap->size * sizeof (Term));
+  snap->to = (Term *) malloc (snap->size * sizeof (Term));
+  memset (snap->from, 0, snap->size * sizeof (Term));
+  for (i = 0; i < size; i++)
+    {
+      if (from[i] != NULL)
+	{
+	  int j;
+
+	  j = snapshotSlot (snap, from[i]);
+	  snap->from[j] = from[i];
+	  snap->to[j] = to[i];
+	}
+    }
+  free (from);
+  free (to);
+}
+
+//! Copy a term
+/**
+ * Global leaves without a substitution are shared; everything else is
+ * copied once, such that shared subterms stay shared in the copy.
+ */
+static Term
+snapshotTerm (const Snapshot snap, const Term t)
+{
+  Term tnew;
+  int i;
+
+  if (t == NULL)
+    {
+      return NULL;
+    }
+  if (realTermLeaf (t) && TermRunid (t) < 0 && t->subst == NULL)
+    {
+      return t;
+    }
+  if (2 * (snap->count + 1) > snap->size)
+    {
+      snapshotGrow (snap);
+    }
+  i = snapshotSlot (snap, t);
+  if (snap->from[i] != NULL)
+    {
+      return snap->to[i];
+    }
+  tnew = (Term) malloc (sizeof (struct term));
+  memcpy (tnew, t, sizeof (struct term));
+  snap->from[i] = t;
+  snap->to[i] = tnew;
+  snap->count++;
+
+  if (realTermLeaf (t))
+    {
+      tnew->subst = snapshotTerm (snap, t->subst);
+    }
+  else if (realTermEncrypt (t))
+    {
+      TermOp (tnew) = snapshotTerm (snap, TermOp (t));
+      TermKey (tnew) = snapshotTerm (snap, TermKey (t));
+    }
+  else
+    {
+      TermOp1 (tnew) = snapshotTerm (snap, TermOp1 (t));
+      TermOp2 (tnew) = snapshotTerm (snap, TermOp2 (t));
+    }
+  return tnew;
+}
+
+//! Copy a termlist, keeping the order
+static Termlist
+snapshotTermlist (const Snapshot snap, Termlist tl)
+{
+  Termlist tlnew;
+
+  tlnew = NULL;
+  while (tl != NULL)
+    {
+      tlnew = termlistAppend (tlnew, snapshotTerm (snap, tl->term));
+      tl = tl->next;
+    }
+  return tlnew;
+}
+
+//! Copy the events of a run
+static Roledef
+snapshotRoledef (const Snapshot snap, Roledef rd)
+{
+  Roledef head, last;
+
+  head = NULL;
+  last = NULL;
+  while (rd != NULL)
+    {
+      Roledef rdnew;
+
+      rdnew = (Roledef) malloc (sizeof (struct roledef));
+      memcpy (rdnew, rd, sizeof (struct roledef));
+      rdnew->label = snapshotTerm (snap, rd->label);
+      rdnew->from = snapshotTerm (snap, rd->from);
+      rdnew->to = snapshotTerm (snap, rd->to);
+      rdnew->message = snapshotTerm (snap, rd->message);
+      rdnew->next = NULL;
+      if (last == NULL)
+	{
+	  head = rdnew;
+	}
+      else
+	{
+	  last->next = rdnew;
+	}
+      last = rdnew;
+      rd = rd->next;
+    }
+  return head;
+}
+
+//! Copy a run
+static void
+snapshotRun (const Snapshot snap, Run rnew, const Run r)
+{
+  Roledef rd, rdnew;
+
+  memcpy (rnew, r, sizeof (struct run));
+  rnew->start = snapshotRoledef (snap, r->start);
+  // The index points into the copied events
+  rnew->index = NULL;
+  for (rd = r->start, rdnew = rnew->start; rd != NULL;
+       rd = rd->next, rdnew = rdnew->next)
+    {
+      if (rd == r->index)
+	{
+	  rnew->index = rdnew;
+	}
+    }
+  rnew->rho = snapshotTermlist (snap, r->rho);
+  rnew->sigma = snapshotTermlist (snap, r->sigma);
+  rnew->constants = snapshotTermlist (snap, r->constants);
+  rnew->locals = snapshotTermlist (snap, r->locals);
+  rnew->artefacts = NULL;
+  rnew->substitutions = NULL;
+}
+
+//! Copy the current semitrace
+Snapshot
+snapshotTake (const System sys)
+{
+  Snapshot snap;
+  List bl;
+  int run;
+
+  snap = (Snapshot) malloc (sizeof (struct snapshot));
+  snap->from = NULL;
+  snap->to = NULL;
+  snap->size = 0;
+  snap->count = 0;
+  snap->saved_capacity = 0;
+
+  snap->maxruns = sys->maxruns;
+  snap->runs = (Run) malloc ((sys->maxruns + 1) * sizeof (struct run));
+  for (run = 0; run < sys->maxruns; run++)
+    {
+      snapshotRun (snap, &(snap->runs[run]), &(sys->runs[run]));
+    }
+
+  snap->bindings = NULL;
+  for (bl = sys->bindings; bl != NULL; bl = bl->next)
+    {
+      Binding b, bnew;
+
+      b = (Binding) bl->data;
+      bnew = (Binding) malloc (sizeof (struct binding));
+      memcpy (bnew, b, sizeof (struct binding));
+      bnew->term = snapshotTerm (snap, b->term);
+      snap->bindings = list_append (snap->bindings, bnew);
+    }
+
+  snap->depend = dependSnapshot ();
+
+  snap->attackid = sys->attackid;
+  snap->num_regular_runs = sys->num_regular_runs;
+  snap->num_intruder_runs = sys->num_intruder_runs;
+  snap->num_initiator_runs = sys->num_initiator_runs;
+  snap->num_intruder_actions = sys->num_intruder_actions;
+  snap->num_bindings_done = sys->num_bindings_done;
+  snap->semitrace_length = sys->semitrace_length;
+  return snap;
+}
+
+//! Exchange the semitrace of the system and the snapshot
+static void
+snapshotSwap (const System sys, const Snapshot snap)
+{
+  Run runs;
+  List bindings;
+  int i;
+
+#define SWAPINT(x) { i = sys->x; sys->x = snap->x; snap->x = i; }
+  runs = sys->runs;
+  sys->runs = snap->runs;
+  snap->runs = runs;
+  bindings = sys->bindings;
+  sys->bindings = snap->bindings;
+  snap->bindings = bindings;
+  SWAPINT (maxruns);
+  SWAPINT (attackid);
+  SWAPINT (num_regular_runs);
+  SWAPINT (num_intruder_runs);
+  SWAPINT (num_initiator_runs);
+  SWAPINT (num_intruder_actions);
+  SWAPINT (num_bindings_done);
+  SWAPINT (semitrace_length);
+#undef SWAPINT
+}
+
+//! Put the snapshot in place of the current semitrace
+/**
+ * Nothing may extend the semitrace until snapshotRemove is called.
+ */
+void
+snapshotInstall (const System sys, const Snapshot snap)
+{
+  snap->saved_capacity = sys->runs_capacity;
+  snapshotSwap (sys, snap);
+  sys->runs_capacity = sys->maxruns;
+  dependPushSnapshot (sys, snap->depend);
+}
+
+//! Put the original semitrace back
+void
+snapshotRemove (const System sys, const Snapshot snap)
+{
+  snapshotSwap (sys, snap);
+  sys->runs_capacity = snap->saved_capacity;
+  dependPopSnapshot (sys);
+}
+
+//! Free a snapshot
+void
+snapshotDelete (Snapshot snap)
+{
+  List bl;
+  int run;
+  int i;
+
+  for (run = 0; run < snap->maxruns; run++)
+    {
+      Roledef rd;
+
+      rd = snap->runs[run].start;
+      while (rd != NULL)
+	{
+	  Roledef next;
+
+	  next = rd->next;
+	  free (rd);
+	  rd = next;
+	}
+      termlistDelete (snap->runs[run].rho);
+      termlistDelete (snap->runs[run].sigma);
+      termlistDelete (snap->runs[run].constants);
+      termlistDelete (snap->runs[run].locals);
+    }
+  free (snap->runs);
+
+  for (bl = snap->bindings; bl != NULL; bl = bl->next)
+    {
+      free (bl->data);
+    }
+  list_destroy (snap->bindings);
+
+  dependSnapshotDelete (snap->depend);
+
+  for (i = 0; i < snap->size; i++)
+    {
+      if (snap->from[i] != NULL)
+	{
+	  free (snap->to[i]);
+	}
+    }
+  free (snap->from);
+  free (snap->to);
+  free (snap);
+}
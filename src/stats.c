@@ -0,0 +1,222 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file stats.c
+ * \brief Counters for the hot paths of the search (--stats)
+ *
+ * When a protocol explodes, the number of states alone does not say why.
+ * These counters show where the work goes: unification, the dependency
+ * graph, goals, the rules that prune states, and the roles of the runs
+ * that are created.
+ */
+
+#include <string.h>
+
+#include "stats.h"
+#include "switches.h"
+#include "error.h"
+#include "claim.h"
+#include "timer.h"
+
+/*
+ * Externally defined
+ */
+extern Protocol INTRUDER;	// from arachne.c
+
+//! The counters
+struct statistics stats;
+
+//! Names of the prune rules, in the order of enum prunerules
+static const char *prunenames[PRUNE_RULES] = {
+  "substitution", "multiple-roles", "self-initiator", "self-responder",
+  "unique-roles", "agent-type", "untrusted", "redundant", "inequality",
+  "local-order", "hidden", "function", "encryption-level", "hidelevel",
+  "singular",
+  "claim-trusted", "niagree", "nisynch", "weakagree", "alive", "commit",
+  "time", "max-states", "memory", "restart", "max-attacks", "proof-depth",
+  "trace-length", "runs", "role-instances", "intruder-runs",
+  "attack-length", "attack-cost", "no-intruder", "intruder-actions"
+};
+
+//! Names of the subsystems, in the order of enum memsystems
+static const char *memorynames[MEM_SYSTEMS] = {
+  "terms", "termlists", "lists", "depend", "bindings", "knowledge", "symbols"
+};
+
+//! Memory accounting at the start of the current claim
+static struct memaccount memoryclaim[MEM_SYSTEMS];
+
+//! Init counters
+void
+statsInit (void)
+{
+  memset (&stats, 0, sizeof (stats));
+  memset (memoryclaim, 0, sizeof (memoryclaim));
+}
+
+//! Name of a prune rule
+const char *
+statsPruneName (const int rule)
+{
+  return prunenames[rule];
+}
+
+//! Print a single counter line
+static void
+statsLine (const char *name, const states_t value)
+{
+  eprintf ("stats\t%s\t", name);
+  statesFormat (value);
+  eprintf ("\n");
+}
+
+//! Print the runs created for the roles of a protocol
+static void
+statsRoleRuns (const Protocol p)
+{
+  Role r;
+
+  for (r = p->roles; r != NULL; r = r->next)
+    {
+      if (r->created > 0)
+	{
+	  eprintf ("stats\truns\t");
+	  termPrint (p->nameterm);
+	  eprintf (",");
+	  termPrint (r->nameterm);
+	  eprintf ("\t");
+	  statesFormat (r->created);
+	  eprintf ("\n");
+	}
+    }
+}
+
+//! Print the counters as text
+/**
+ * One counter per line, tab separated like the claim lines of the summary.
+ */
+void
+statsPrint (const System sys)
+{
+  Protocol p;
+  int rule;
+
+  statsLine ("states", sys->states);
+  statsLine ("unify", stats.unify);
+  statsLine ("unifiers", stats.unifiers);
+  statsLine ("subterm-unify", stats.subterm_unify);
+  statsLine ("subterm-unifiers", stats.subterm_unifiers);
+  statsLine ("depend-pushes", stats.depend_pushes);
+  statsLine ("depend-zombies", stats.depend_zombies);
+  statsLine ("depend-cycles", stats.depend_cycles);
+  statsLine ("closures", stats.closures);
+  statsLine ("depend-graphs", sys->depend_graphs);
+  statsLine ("depend-allocations", sys->depend_allocations);
+  statsLine ("goals-added", stats.goals_added);
+  statsLine ("goal-binds", stats.goal_binds);
+  statsLine ("goal-binds-done", stats.goal_binds_done);
+  statsLine ("run-changes", sys->run_changes);
+  statsLine ("run-allocations", sys->run_allocations);
+  statsLine ("terms", stats.memory[MEM_TERMS].allocations);
+  statsLine ("termlists", stats.memory[MEM_TERMLISTS].allocations);
+  for (rule = 0; rule < PRUNE_RULES; rule++)
+    {
+      if (stats.prunes[rule] > 0)
+	{
+	  eprintf ("stats\tprune\t%s\t", prunenames[rule]);
+	  statesFormat (stats.prunes[rule]);
+	  eprintf ("\n");
+	}
+    }
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      statsRoleRuns (p);
+    }
+  statsRoleRuns (INTRUDER);
+}
+
+//! Name of a subsystem with memory accounting
+const char *
+statsMemoryName (const int sub)
+{
+  return memorynames[sub];
+}
+
+//! Start the memory accounting of a claim
+/**
+ * The peaks are reset, such that they are per claim.
+ */
+void
+statsMemoryClaim (void)
+{
+  int sub;
+
+  for (sub = 0; sub < MEM_SYSTEMS; sub++)
+    {
+      stats.memory[sub].peak = stats.memory[sub].live;
+      memoryclaim[sub] = stats.memory[sub];
+    }
+}
+
+//! Report the memory accounting of a claim (--report-memory)
+/**
+ * Tab separated, like the claim lines of the summary. For each subsystem,
+ * the allocations during the claim, the bytes that are still allocated,
+ * their peak during the claim, and the change since its start. Once a
+ * claim is done, its search has undone everything, so a subsystem that
+ * keeps growing from claim to claim leaks memory. The exception is the
+ * dependency graph pool, which is kept and only grows with the depth of
+ * the search.
+ */
+void
+statsMemoryReport (const System sys, const Claimlist cl)
+{
+  long rss;
+  int sub;
+
+  if (switches.output != SUMMARY)
+    {
+      globalError++;
+    }
+
+  eprintf ("memory\tclaim\t");
+  claimNamePrint (cl);
+  rss = peak_memory_kilobytes ();
+  if (rss >= 0)
+    {
+      eprintf ("\tpeak-rss=%likB", rss);
+    }
+  eprintf ("\n");
+  for (sub = 0; sub < MEM_SYSTEMS; sub++)
+    {
+      struct memaccount *m;
+
+      m = &(stats.memory[sub]);
+      eprintf ("memory\t%s\tallocations=", memorynames[sub]);
+      statesFormat (m->allocations - memoryclaim[sub].allocations);
+      eprintf ("\tlive=%li\tpeak=%li\tgrowth=%li\n", m->live, m->peak,
+	       m->live - memoryclaim[sub].live);
+    }
+
+  if (switches.output != SUMMARY)
+    {
+      globalError--;
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef STATS
+#define STATS
+
+#include "states.h"
+#include "system.h"
+
+//! Reasons for pruning a state, for the statistics
+enum prunerules
+{
+  /* prune_theorems */
+  PRUNE_SUBSTITUTION, PRUNE_MULTIPLE_ROLES, PRUNE_SELF_INITIATOR,
+  PRUNE_SELF_RESPONDER, PRUNE_UNIQUE_ROLES, PRUNE_AGENT_TYPE,
+  PRUNE_UNTRUSTED, PRUNE_REDUNDANT, PRUNE_INEQUALITY, PRUNE_LOCAL_ORDER,
+  PRUNE_HIDDEN, PRUNE_FUNCTION, PRUNE_ENCRYPTION_LEVEL, PRUNE_HIDELEVEL,
+  PRUNE_SINGULAR,
+  /* prune_claim_specifics */
+  PRUNE_CLAIM_TRUSTED, PRUNE_NIAGREE, PRUNE_NISYNCH, PRUNE_WEAKAGREE,
+  PRUNE_ALIVE, PRUNE_COMMIT,
+  /* prune_bounds */
+  PRUNE_TIME, PRUNE_MAX_STATES, PRUNE_MEMORY, PRUNE_RESTART,
+  PRUNE_MAX_ATTACKS, PRUNE_PROOF_DEPTH, PRUNE_TRACE_LENGTH, PRUNE_RUNS,
+  PRUNE_ROLE_INSTANCES, PRUNE_INTRUDER_RUNS, PRUNE_ATTACK_LENGTH,
+  PRUNE_ATTACK_COST, PRUNE_NO_INTRUDER, PRUNE_INTRUDER_ACTIONS,
+  PRUNE_RULES
+};
+
+//! Subsystems with their own memory accounting
+enum memsystems
+{ MEM_TERMS, MEM_TERMLISTS, MEM_LISTS, MEM_DEPEND, MEM_BINDINGS,
+  MEM_KNOWLEDGE, MEM_SYMBOLS, MEM_SYSTEMS
+};
+
+//! Memory accounting of a subsystem
+struct memaccount
+{
+  states_t allocations;		//!< Number of allocations
+  long live;			//!< Bytes allocated and not freed yet
+  long peak;			//!< Maximum of live, since the start of the claim
+};
+
+//! Counters for the hot paths of the search
+/**
+ * These are always counted, as a single increment is cheaper than testing
+ * whether we should; they are only reported with --stats.
+ */
+struct statistics
+{
+  states_t unify;		//!< Calls of unify, including the recursive ones
+  states_t unifiers;		//!< Unifiers handed to the caller of unify
+  states_t subterm_unify;	//!< Calls of subtermUnify
+  states_t subterm_unifiers;	//!< Unifiers found by subtermUnify
+  states_t depend_pushes;	//!< Edges that changed the dependency graph
+  states_t depend_zombies;	//!< Edges that were already in the graph
+  states_t depend_cycles;	//!< Edges rejected because of a cycle
+  states_t closures;		//!< Transitive closure computations
+  states_t goals_added;		//!< New goals from goal_add
+  states_t goal_binds;		//!< Calls of goal_bind
+  states_t goal_binds_done;	//!< Successful goal_bind calls
+  states_t prunes[PRUNE_RULES];	//!< States pruned, per rule
+  struct memaccount memory[MEM_SYSTEMS];	//!< Memory, per subsystem
+};
+
+extern struct statistics stats;
+
+//! Account for an allocation of a subsystem
+#define statsMalloc(sub,bytes) do { \
+  stats.memory[sub].allocations++; \
+  stats.memory[sub].live += (long) (bytes); \
+  if (stats.memory[sub].live > stats.memory[sub].peak) \
+    stats.memory[sub].peak = stats.memory[sub].live; \
+} while (0)
+
+//! Account for a free of a subsystem
+#define statsFree(sub,bytes) do { \
+  stats.memory[sub].live -= (long) (bytes); \
+} while (0)
+
+void statsInit (void);
+const char *statsPruneName (const int rule);
+void statsPrint (const System sys);
+const char *statsMemoryName (const int sub);
+void statsMemoryClaim (void);
+void statsMemoryReport (const System sys, const Claimlist cl);
+
+#endif
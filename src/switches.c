@@ -33,6 +33,8 @@
 #include "switches.h"
 #include "error.h"
 #include "specialterm.h"
+#include "heuristic.h"
+#include "restart.h"
 
 // Program name
 const char *progname = "scyther";
@@ -69,11 +71,16 @@ switchesInit (int argc, char **argv)
   switches.filterProtocol = NULL;	// default check all claims
   switches.filterLabel = NULL;	// default check all claims
   switches.maxAttacks = 0;	// no maximum default
+  switches.maxStates = 0;	// no maximum default
   switches.maxOfRole = 0;	// no maximum default
   switches.oneRolePerAgent = 0;	// agents can perform multiple roles
 
   // Arachne
   switches.heuristic = 674;	// default goal selection method (used to be 162)
+  switches.heuristicProfile = NULL;	// default no per-protocol settings
+  switches.restarts = 0;	// default no randomized restarts
+  switches.restartBase = 1000;	// states per restart budget unit
+  switches.restartSchedule = RESTART_LUBY;
   switches.maxIntruderActions = INT_MAX;	// max number of encrypt/decrypt events
   switches.agentTypecheck = 1;	// default do check agent types
   switches.concrete = true;	// default removes symbols, and makes traces concrete
@@ -84,7 +91,7 @@ switchesInit (int argc, char **argv)
   switches.chosenName = false;	// default no chosen name attacks
   switches.agentUnfold = 0;	// default not to unfold agents
   switches.abstractionMethod = 0;	// default no abstraction used
-  switches.useAttackBuffer = false;	// don't use by default as it does not work properly under windows vista yet
+  switches.useAttackBuffer = false;	// only output the final attack when pruning (--buffer-attacks)
 
   // Misc
   switches.switchP = 0;		// multi-purpose parameter
@@ -100,11 +107,18 @@ switchesInit (int argc, char **argv)
   switches.report = 0;
   switches.reportClaims = 0;	// default don't report on claims
   switches.xml = false;		// default no xml output 
+  switches.json = false;	// default no JSON output
   switches.dot = false;		// default no dot output
   switches.human = false;	// not human friendly by default
-  switches.reportMemory = 0;
+  switches.reportMemory = false;	// default off
   switches.reportTime = 0;
   switches.countStates = false;	// default off
+  switches.stats = false;	// default off
+  switches.profile = 0;		// default off
+  switches.traceEvents = NULL;	// default no timeline
+  switches.progress = 0;	// default only on SIGUSR1
+  switches.progressFile = NULL;	// default to stderr
+  switches.cache = NULL;	// default no result cache
   switches.extendNonRecvs = 0;	// default off
   switches.extendTrivial = 0;	// default off
   switches.plain = false;	// default colors for terminal
@@ -513,6 +527,23 @@ switcher (const int process, int index, int commandline)
 	}
     }
 
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "json-output", 0))
+    {
+      if (!process)
+	{
+	  helptext ("    --json-output",
+		    "show claims and patterns as JSON lines, sharing terms");
+	}
+      else
+	{
+	  switches.output = ATTACK;
+	  switches.json = true;
+	  return index;
+	}
+    }
+
   if (detect
       (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
        ' ', "proof", 0))
@@ -746,6 +777,47 @@ switcher (const int process, int index, int commandline)
 	}
     }
 
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "max-memory", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --max-memory=<int>",
+			"maximum memory use in megabytes [inf]");
+	    }
+	}
+      else
+	{
+	  set_memory_limit (integer_argument (arg_pointer));
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "max-states", 1))
+    {
+      if (!process)
+	{
+	  helptext ("    --max-states=<int>",
+		    "maximum number of states per claim [inf]");
+	}
+      else
+	{
+	  if (arg_pointer == NULL
+	      || sscanf (arg_pointer, "%lu", &switches.maxStates) != 1)
+	    {
+	      error ("Could not parse expected integer argument.");
+	    }
+	  arg_next;
+	  return index;
+	}
+    }
+
   if (detect
       (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
        'r', "max-runs", 1))
@@ -888,6 +960,25 @@ switcher (const int process, int index, int commandline)
 	}
     }
 
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "buffer-attacks", 0))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --buffer-attacks",
+			"when pruning, only output the final attack");
+	    }
+	}
+      else
+	{
+	  switches.useAttackBuffer = true;
+	  return index;
+	}
+    }
+
   if (detect
       (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
        'H', "human-readable", 0))
@@ -1058,6 +1149,148 @@ switcher (const int process, int index, int commandline)
 	}
     }
 
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "heuristic-weights", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --heuristic-weights=<list>",
+			"comma-separated multipliers per heuristic bit [1,...]");
+	    }
+	}
+      else
+	{
+	  if (arg_pointer == NULL)
+	    {
+	      error ("Argument expected.");
+	    }
+	  heuristicSetWeights (arg_pointer);
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "heuristic-profile", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --heuristic-profile=<FILE>",
+			"per-protocol heuristic settings");
+	    }
+	}
+      else
+	{
+	  if (arg_pointer == NULL)
+	    {
+	      error ("Argument expected.");
+	    }
+	  switches.heuristicProfile = arg_pointer;
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "restarts", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --restarts=<int>",
+			"randomized restarts before the full search [0]");
+	    }
+	}
+      else
+	{
+	  switches.restarts = integer_argument (arg_pointer);
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "restart-base", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --restart-base=<int>",
+			"states per restart budget unit [1000]");
+	    }
+	}
+      else
+	{
+	  switches.restartBase = integer_argument (arg_pointer);
+	  if (switches.restartBase < 1)
+	    {
+	      error ("--restart-base must be positive.");
+	    }
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "restart-schedule", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --restart-schedule=<luby|geometric>",
+			"restart budget schedule [luby]");
+	    }
+	}
+      else
+	{
+	  if (arg_pointer != NULL && !strcmp (arg_pointer, "luby"))
+	    {
+	      switches.restartSchedule = RESTART_LUBY;
+	    }
+	  else if (arg_pointer != NULL && !strcmp (arg_pointer, "geometric"))
+	    {
+	      switches.restartSchedule = RESTART_GEOMETRIC;
+	    }
+	  else
+	    {
+	      error ("Unknown restart schedule, use luby or geometric.");
+	    }
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "seed", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --seed=<int>", "random seed for restarts [0]");
+	    }
+	}
+      else
+	{
+	  restartSeed ((unsigned int) integer_argument (arg_pointer));
+	  arg_next;
+	  return index;
+	}
+    }
+
   if (detect
       (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
        ' ', "agent-unfold", 1))
@@ -1418,6 +1651,156 @@ switcher (const int process, int index, int commandline)
 	}
     }
 
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "stats", 0))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --stats",
+			"report the counters of the search (after the claims)");
+	    }
+	}
+      else
+	{
+	  switches.stats = true;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "profile", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --profile=<int>",
+			"report the <int> goals and sends with most states (per claim)");
+	    }
+	}
+      else
+	{
+	  switches.profile = integer_argument (arg_pointer);
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "report-memory", 0))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --report-memory",
+			"report the memory of each subsystem (per claim)");
+	    }
+	}
+      else
+	{
+	  switches.reportMemory = true;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "trace-events", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --trace-events=<FILE>",
+			"write a timeline of the phases to <FILE> (Chrome trace format)");
+	    }
+	}
+      else
+	{
+	  if (arg_pointer == NULL)
+	    {
+	      error ("Argument expected.");
+	    }
+	  switches.traceEvents = arg_pointer;
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "progress", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --progress=<int>",
+			"report the progress of a claim every <int> seconds (also on SIGUSR1)");
+	    }
+	}
+      else
+	{
+	  switches.progress = integer_argument (arg_pointer);
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "progress-file", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --progress-file=<FILE>",
+			"write the progress reports to <FILE> instead of stderr");
+	    }
+	}
+      else
+	{
+	  if (arg_pointer == NULL)
+	    {
+	      error ("Argument expected.");
+	    }
+	  switches.progressFile = arg_pointer;
+	  arg_next;
+	  return index;
+	}
+    }
+
+  if (detect
+      (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
+       ' ', "cache", 1))
+    {
+      if (!process)
+	{
+	  if (switches.expert)
+	    {
+	      helptext ("    --cache=<DIR>",
+			"reuse the results of claims stored in <DIR>");
+	    }
+	}
+      else
+	{
+	  if (arg_pointer == NULL)
+	    {
+	      error ("Argument expected.");
+	    }
+	  switches.cache = arg_pointer;
+	  arg_next;
+	  return index;
+	}
+    }
+
   if (detect
       (this_arg_length, this_arg, argv, argc, process, &arg_pointer, &index,
        ' ', "echo", 0))
@@ -45,11 +45,16 @@ struct switchdata
   char *filterProtocol;		//!< Which claim should be checked?
   char *filterLabel;		//!< Which claim should be checked?
   int maxAttacks;		//!< When not 0, maximum number of attacks
+  states_t maxStates;		//!< When not 0, maximum number of states per claim
   int maxOfRole;		//!< When not 0, maximum number of instances of each unique (non intruder) role
   int oneRolePerAgent;		//!< When 0, agents can perform multiple roles
 
   // Arachne
   int heuristic;		//!< Goal selection method for Arachne engine
+  char *heuristicProfile;	//!< File with per-protocol heuristic settings
+  int restarts;			//!< Number of randomized restarts before the full search
+  int restartBase;		//!< State budget unit for restarts
+  int restartSchedule;		//!< From enum restartschedules
   int maxIntruderActions;	//!< Maximum number of intruder actions in the semitrace (encrypt/decrypt)
   int agentTypecheck;		//!< Check type of agent variables in all matching modes
   int concrete;			//!< Swap out variables at the end.
@@ -60,7 +65,7 @@ struct switchdata
   int chosenName;		//!< Check for chosen name attacks
   int agentUnfold;		//!< Explicitly unfold for N honest agents and 1 compromised iff > 0
   int abstractionMethod;	//!< 0 means none, others are specific modes
-  int useAttackBuffer;		//!< Use temporary file for attack storage
+  int useAttackBuffer;		//!< Keep a copy of the last attack, output only that one
 
   // Misc
   int switchP;			//!< A multi-purpose integer parameter, passed to the partial order reduction method selected.
@@ -76,11 +81,18 @@ struct switchdata
   int report;
   int reportClaims;		//!< Enable claims report
   int xml;			//!< xml output
+  int json;			//!< JSON lines output
   int dot;			//!< dot output
   int human;			//!< human readable
   int reportMemory;		//!< Memory display switch.
   int reportTime;		//!< Time display switch.
   int countStates;		//!< Count states
+  int stats;			//!< Report the counters of the search
+  int profile;			//!< Report the top <int> of the proof tree profile
+  char *traceEvents;		//!< File for a timeline of the phases
+  int progress;			//!< Report the progress every <int> seconds
+  char *progressFile;		//!< File for the progress reports, instead of stderr
+  char *cache;			//!< Directory for the results of claims
   int extendNonRecvs;		//!< Show further events in arachne xml output.
   int extendTrivial;		//!< Show further events in arachne xml output, based on knowledge underapproximation. (Includes at least the events of the nonreads extension)
   int plain;			//!< Disable color output on terminal
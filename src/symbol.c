@@ -26,6 +26,8 @@
 #include "symbol.h"
 #include "debug.h"
 #include "error.h"
+#include "stats.h"
+#include "cache.h"
 
 /*
    Symbol processor.
@@ -79,6 +81,7 @@ symbolsDone (void)
     {
       s = symb_alloc;
       symb_alloc = s->allocnext;
+      statsFree (MEM_SYMBOLS, sizeof (struct symbol));
       free (s);
     }
 }
@@ -99,6 +102,7 @@ get_symb (void)
     }
   else
     {
+      statsMalloc (MEM_SYMBOLS, sizeof (struct symbol));
       t = (Symbol) malloc (sizeof (struct symbol));
       t->allocnext = symb_alloc;
       symb_alloc = t;
@@ -275,6 +279,7 @@ symbolNextFree (Symbol prefixsymbol)
 	   * Thus, some precaution is necessary.
 	   * [x][CC]
 	   */
+	  statsMalloc (MEM_SYMBOLS, slen + 1);
 	  newstring = (char *) malloc (slen + 1);
 	  memcpy (newstring, buffer, slen + 1);
 
@@ -333,6 +338,7 @@ symbolFromInt (int n, Symbol prefixsymbol)
 	   * Thus, some precaution is necessary.
 	   * [x][CC]
 	   */
+      statsMalloc (MEM_SYMBOLS, slen + 1);
       newstring = (char *) malloc (slen + 1);
       memcpy (newstring, buffer, slen + 1);
 
@@ -425,6 +431,14 @@ eprintf (char *fmt, ...)
   stream = getOutputStream ();
   if (stream != NULL)
     {
+      if (cache_capturing)
+	{
+	  va_list copy;
+
+	  va_copy (copy, args);
+	  cacheCapture (globalError > 0, fmt, copy);
+	  va_end (copy);
+	}
       vfprintf (stream, fmt, args);
     }
   va_end (args);
@@ -439,6 +453,31 @@ veprintf (const char *fmt, va_list args)
   stream = getOutputStream ();
   if (stream != NULL)
     {
+      if (cache_capturing)
+	{
+	  va_list copy;
+
+	  va_copy (copy, args);
+	  cacheCapture (globalError > 0, fmt, copy);
+	  va_end (copy);
+	}
       vfprintf (stream, fmt, args);
     }
 }
+
+//! Flush the output stream
+/**
+ * Used after each complete record, such that a reader on a pipe gets the
+ * results as they come.
+ */
+void
+eflush (void)
+{
+  FILE *stream;
+
+  stream = getOutputStream ();
+  if (stream != NULL)
+    {
+      fflush (stream);
+    }
+}
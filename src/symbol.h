@@ -71,6 +71,7 @@ Symbol symbolFromInt (int n, Symbol prefixsymbol);
 
 void eprintf (char *fmt, ...);
 void veprintf (const char *fmt, va_list args);
+void eflush (void);
 
 extern int globalError;
 extern char *globalStream;
@@ -46,6 +46,8 @@ extern Protocol INTRUDER;
 //! Current indent depth.
 static int indentDepth = 0;
 
+static void templatesDone (const System sys);
+
 //! Initialise a system structure.
 /**
  *@return A system structure pointer with initial values.
@@ -63,6 +65,11 @@ systemInit ()
   /* init rundefs */
   sys->maxruns = 0;
   sys->runs = NULL;
+  sys->runs_capacity = 0;
+  sys->run_changes = 0;
+  sys->run_allocations = 0;
+  sys->depend_graphs = 0;
+  sys->depend_allocations = 0;
   /* no protocols yet */
   protocolCount = 0;
   sys->protocols = NULL;
@@ -123,6 +130,11 @@ systemReset (const System sys)
   sys->secrets = NULL;		// list of claimed secrets
   sys->num_intruder_runs = 0;	// number of intruder runs
   sys->num_regular_runs = 0;	// number of regular runs
+  sys->num_initiator_runs = 0;
+  sys->num_intruder_actions = 0;
+  sys->num_bindings_done = 0;
+  sys->semitrace_length = 0;
+  sys->regular_steps = 0;
 
   /* transfer switches */
   sys->maxtracelength = switches.maxtracelength;
@@ -171,6 +183,7 @@ systemDone (const System sys)
     {
       roleInstanceDestroy (sys);
     }
+  templatesDone (sys);
 
   /* undo bindings (for arachne) */
 
@@ -210,13 +223,25 @@ ensureValidRun (const System sys, int run)
     return;
 
   /* this amount of memory was not allocated yet */
-  /* (re)allocate  space */
+  /* (re)allocate  space, geometrically, so that creating and destroying
+     runs during the search hardly ever needs to realloc */
   /* Note, this is never explicitly freed, because it is never
      copied */
+  if (run >= sys->runs_capacity)
+    {
+      sys->runs_capacity = 2 * sys->runs_capacity;
+      if (sys->runs_capacity <= run)
+	{
+	  sys->runs_capacity = run + 8;
+	}
+      sys->runs =
+	(Run) realloc (sys->runs, sizeof (struct run) * (sys->runs_capacity));
+      sys->run_allocations++;
+    }
   /* update size parameter */
   oldsize = sys->maxruns;
   sys->maxruns = run + 1;
-  sys->runs = (Run) realloc (sys->runs, sizeof (struct run) * (sys->maxruns));
+  sys->run_changes++;
 
   /* create runs, set the new pointer(s) to NULL */
   for (i = oldsize; i < sys->maxruns; i++)
@@ -561,6 +586,283 @@ createLocals (const System sys, struct cl_struct *p_data, Termlist list,
     }
 }
 
+/*************************************************
+ *
+ * Run templates
+ *
+ * Localizing a run with termLocal scans the list of new locals for every
+ * leaf of every event. Instead, we compile the events of a role once into a
+ * flat array of cells, in which each leaf that must be replaced already
+ * refers to its local by index. Instantiating a run is then a single walk
+ * over this array.
+ *
+*************************************************/
+
+//! Cell kinds of a run template
+enum templatecells
+{ TCELL_TERM, TCELL_LOCAL, TCELL_NODE };
+
+//! A single cell of a run template, in prefix order
+struct templatecell
+{
+  int kind;			//!< TCELL_TERM, TCELL_LOCAL, or TCELL_NODE
+  int local;			//!< Index of the local, for TCELL_LOCAL
+  Term term;			//!< Shared leaf, or node to duplicate (TCELL_NODE)
+};
+
+//! Compiled events of a role
+struct runtemplate
+{
+  int nevents;			//!< Number of events
+  Term *sources;		//!< The from, to, message terms it was built from
+  int *offsets;			//!< First cell of each of these terms
+  int nlocals;			//!< Number of locals created per run
+  Term *locals;			//!< The terms they replace, in creation order
+  int ncells;			//!< Number of cells
+  int maxcells;			//!< Allocated number of cells
+  struct templatecell *cells;	//!< Cells
+};
+
+//! Buffer for the fresh locals of a run, shared by all templates
+static Term *template_locals = NULL;
+static int template_maxlocals = 0;
+
+//! Append a cell to a run template
+static void
+templateAddCell (struct runtemplate *rt, const int kind, const int local,
+		 const Term term)
+{
+  if (rt->ncells == rt->maxcells)
+    {
+      rt->maxcells = 2 * rt->maxcells + 16;
+      rt->cells =
+	(struct templatecell *) realloc (rt->cells,
+					 rt->maxcells *
+					 sizeof (struct templatecell));
+    }
+  rt->cells[rt->ncells].kind = kind;
+  rt->cells[rt->ncells].local = local;
+  rt->cells[rt->ncells].term = term;
+  rt->ncells++;
+}
+
+//! Compile a term into template cells; mirrors termLocal
+static void
+templateCompileTerm (struct runtemplate *rt, const Term tPre)
+{
+  Term t;
+
+  if (tPre == NULL)
+    {
+      templateAddCell (rt, TCELL_TERM, 0, NULL);
+      return;
+    }
+  t = deVar (tPre);
+  if (realTermLeaf (t))
+    {
+      int i;
+
+      // termLocal takes the most recently created matching local
+      for (i = rt->nlocals - 1; i >= 0; i--)
+	{
+	  if (isTermEqual (rt->locals[i], t))
+	    {
+	      templateAddCell (rt, TCELL_LOCAL, i, NULL);
+	      return;
+	    }
+	}
+      templateAddCell (rt, TCELL_TERM, 0, t);
+    }
+  else
+    {
+      templateAddCell (rt, TCELL_NODE, 0, t);
+      // For tuples op1/op2, for encryptions op/key
+      templateCompileTerm (rt, t->left.op);
+      templateCompileTerm (rt, t->right.key);
+    }
+}
+
+//! Instantiate a term from template cells
+static Term
+templateInstantiateTerm (struct templatecell **cell, Term * locals)
+{
+  struct templatecell *c;
+  Term newt;
+
+  c = *cell;
+  (*cell)++;
+  switch (c->kind)
+    {
+    case TCELL_LOCAL:
+      return locals[c->local];
+    case TCELL_NODE:
+      newt = termNodeDuplicate (c->term);
+      newt->left.op = templateInstantiateTerm (cell, locals);
+      newt->right.key = templateInstantiateTerm (cell, locals);
+      return newt;
+    default:
+      return c->term;
+    }
+}
+
+//! Add the terms of a list to the locals of a run template
+static void
+templateAddLocals (struct runtemplate *rt, Termlist tl)
+{
+  while (tl != NULL)
+    {
+      rt->locals[rt->nlocals] = tl->term;
+      rt->nlocals++;
+      tl = tl->next;
+    }
+}
+
+//! Compile the run template for a role
+static struct runtemplate *
+templateCreate (const Protocol protocol, const Role role)
+{
+  struct runtemplate *rt;
+  Roledef rd;
+  int i;
+
+  rt = (struct runtemplate *) malloc (sizeof (struct runtemplate));
+  rt->nevents = roledef_length (role->roledef);
+  rt->sources = (Term *) malloc (3 * rt->nevents * sizeof (Term));
+  rt->offsets = (int *) malloc (3 * rt->nevents * sizeof (int));
+  rt->nlocals = 0;
+  rt->locals =
+    (Term *) malloc ((termlistLength (protocol->rolenames) +
+		      termlistLength (role->declaredvars) +
+		      termlistLength (role->declaredconsts)) * sizeof (Term));
+  // Same order as the createLocals calls in roleInstanceArachne
+  templateAddLocals (rt, protocol->rolenames);
+  templateAddLocals (rt, role->declaredvars);
+  templateAddLocals (rt, role->declaredconsts);
+  rt->ncells = 0;
+  rt->maxcells = 0;
+  rt->cells = NULL;
+
+  i = 0;
+  for (rd = role->roledef; rd != NULL; rd = rd->next)
+    {
+      rt->sources[i] = rd->from;
+      rt->offsets[i] = rt->ncells;
+      templateCompileTerm (rt, rd->from);
+      rt->sources[i + 1] = rd->to;
+      rt->offsets[i + 1] = rt->ncells;
+      templateCompileTerm (rt, rd->to);
+      rt->sources[i + 2] = rd->message;
+      rt->offsets[i + 2] = rt->ncells;
+      templateCompileTerm (rt, rd->message);
+      i = i + 3;
+    }
+  return rt;
+}
+
+//! Destroy a run template
+static void
+templateDestroy (struct runtemplate *rt)
+{
+  free (rt->sources);
+  free (rt->offsets);
+  free (rt->locals);
+  free (rt->cells);
+  free (rt);
+}
+
+//! Destroy the run templates of all roles, and the locals buffer
+static void
+templatesDone (const System sys)
+{
+  Protocol p;
+  Role r;
+
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      for (r = p->roles; r != NULL; r = r->next)
+	{
+	  if (r->runtemplate != NULL)
+	    {
+	      templateDestroy (r->runtemplate);
+	      r->runtemplate = NULL;
+	    }
+	}
+    }
+  free (template_locals);
+  template_locals = NULL;
+  template_maxlocals = 0;
+}
+
+//! Check whether a role can be instantiated from a template at all
+/**
+ * Substitutions of role variables change the result of termLocal, so then
+ * we fall back to run_localize.
+ */
+static int
+templateUsable (const Role role)
+{
+  Termlist tl;
+
+  for (tl = role->variables; tl != NULL; tl = tl->next)
+    {
+      if (tl->term->subst != NULL)
+	return false;
+    }
+  return true;
+}
+
+//! Check whether the run template of a role still describes its events
+/**
+ * The intruder roles get their messages assigned while running, in which
+ * case the template is recompiled.
+ */
+static int
+templateValid (const struct runtemplate *rt, const Role role)
+{
+  Roledef rd;
+  int i;
+
+  i = 0;
+  for (rd = role->roledef; rd != NULL; rd = rd->next)
+    {
+      if (i >= 3 * rt->nevents || rt->sources[i] != rd->from
+	  || rt->sources[i + 1] != rd->to || rt->sources[i + 2] != rd->message)
+	return false;
+      i = i + 3;
+    }
+  return (i == 3 * rt->nevents);
+}
+
+//! Localize a run from its role template
+/**
+ * Equivalent to run_localize with the locals in creation order. Assumes
+ * there is no prefixed recv.
+ */
+static void
+run_instantiate (const System sys, const int rid,
+		 const struct runtemplate *rt, Term * locals)
+{
+  Roledef rd;
+  int i;
+
+  rd = sys->runs[rid].start;
+  i = 0;
+  while (rd != NULL)
+    {
+      struct templatecell *cell;
+
+      cell = rt->cells + rt->offsets[i];
+      rd->from = templateInstantiateTerm (&cell, locals);
+      cell = rt->cells + rt->offsets[i + 1];
+      rd->to = templateInstantiateTerm (&cell, locals);
+      cell = rt->cells + rt->offsets[i + 2];
+      rd->message = templateInstantiateTerm (&cell, locals);
+      rd = rd->next;
+      i = i + 3;
+    }
+  sys->runs[rid].substitutions = NULL;
+}
+
 //! Instantiate a role by making a new run for Arachne
 /**
  * This involves creation of a new run(id).
@@ -619,7 +921,43 @@ roleInstanceArachne (const System sys, const Protocol protocol,
   sys->runs[rid].know = NULL;
 
   /* now adjust the local run copy */
-  run_localize (sys, rid, data.fromlist, data.tolist, substlist);
+  if (substlist == NULL && sys->runs[rid].firstReal == 0
+      && templateUsable (role))
+    {
+      Termlist tl;
+      int i;
+
+      if (role->runtemplate != NULL
+	  && !templateValid (role->runtemplate, role))
+	{
+	  templateDestroy (role->runtemplate);
+	  role->runtemplate = NULL;
+	}
+      if (role->runtemplate == NULL)
+	{
+	  role->runtemplate = templateCreate (protocol, role);
+	}
+
+      // The tolist is in reverse creation order
+      if (role->runtemplate->nlocals > template_maxlocals)
+	{
+	  template_maxlocals = role->runtemplate->nlocals;
+	  template_locals = (Term *) realloc (template_locals,
+					      template_maxlocals *
+					      sizeof (Term));
+	}
+      i = role->runtemplate->nlocals;
+      for (tl = data.tolist; tl != NULL; tl = tl->next)
+	{
+	  i--;
+	  template_locals[i] = tl->term;
+	}
+      run_instantiate (sys, rid, role->runtemplate, template_locals);
+    }
+  else
+    {
+      run_localize (sys, rid, data.fromlist, data.tolist, substlist);
+    }
 
   termlistDelete (data.fromlist);
   sys->runs[rid].locals = data.tolist;
@@ -683,32 +1021,16 @@ roleInstanceDestroy (const System sys)
       termlistDelete (myrun.sigma);
       termlistDelete (myrun.constants);
 
-      // sys->variables might contain locals from the run: remove them
-      {
-	Termlist tl;
-
-	tl = sys->variables;
-	while (tl != NULL)
-	  {
-	    Term t;
-
-	    t = tl->term;
-	    if (realTermLeaf (t) && TermRunid (t) == runid)
-	      {
-		Termlist tlnext;
-
-		tlnext = tl->next;
-		// remove from list; return pointer to head
-		sys->variables = termlistDelTerm (tl);
-		tl = tlnext;
-	      }
-	    else
-	      {
-		// proceed
-		tl = tl->next;
-	      }
-	  }
-      }
+      /*
+       * sys->variables might contain locals from the run: remove them.
+       * They were prepended when the run was created, and runs are
+       * destroyed in reverse order, so they are at the head of the list.
+       */
+      while (sys->variables != NULL && realTermLeaf (sys->variables->term)
+	     && TermRunid (sys->variables->term) == runid)
+	{
+	  sys->variables = termlistDelTerm (sys->variables);
+	}
 
       /**
        * Undo the local copies of the substitutions. We cannot restore them however, so this might
@@ -738,7 +1060,7 @@ roleInstanceDestroy (const System sys)
 	artefacts = myrun.artefacts;
 	while (artefacts != NULL)
 	  {
-	    free (artefacts->term);
+	    termFree (artefacts->term);
 	    artefacts = artefacts->next;
 	  }
       }
@@ -747,11 +1069,9 @@ roleInstanceDestroy (const System sys)
       termlistDelete (myrun.artefacts);
       termlistDelete (myrun.locals);
 
-      // Destroy run struct allocation in array using realloc
-      // Reduce run count
+      // Reduce run count; the allocation is kept for the next run
       sys->maxruns = sys->maxruns - 1;
-      sys->runs =
-	(Run) realloc (sys->runs, sizeof (struct run) * (sys->maxruns));
+      sys->run_changes++;
     }
 }
 
@@ -1271,18 +1591,8 @@ eventRoledef (const System sys, const int run, const int ev)
 int
 countInitiators (const System sys)
 {
-  int run;
-  int count;
-
-  count = 0;
-  for (run = 0; run < sys->maxruns; run++)
-    {
-      if (sys->runs[run].role->initiator)
-	{
-	  count++;
-	}
-    }
-  return count;
+  // Maintained by semiRunCreate and semiRunDestroy
+  return sys->num_initiator_runs;
 }
 
 //! Iterate over regular non-helper runs
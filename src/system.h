@@ -102,6 +102,7 @@ struct system
   struct parameters *parameters;	// misc
   /* static run info, maxruns */
   Run runs;
+  int runs_capacity;		//!< Allocated number of entries of runs
 
   /* global */
   int maxruns;			//!< Number of runs in the system.
@@ -124,6 +125,17 @@ struct system
   int attackid;			//!< Global counter of attacks (used for assigning identifiers) within this Scyther call.
   int num_regular_runs;		//!< Number of regular runs
   int num_intruder_runs;	//!< Number of intruder runs
+  int num_initiator_runs;	//!< Number of runs of initiator roles
+  int num_intruder_actions;	//!< Number of intruder runs other than M_0
+  int num_bindings_done;	//!< Number of bound goals
+  int semitrace_length;		//!< Sum of height - firstReal over regular runs
+  int regular_steps;		//!< Sum of height over regular runs
+
+  /* allocation counters */
+  states_t run_changes;		//!< Run creations and destructions
+  states_t run_allocations;	//!< (Re)allocations of runs
+  states_t depend_graphs;	//!< Dependency graphs pushed
+  states_t depend_allocations;	//!< (Re)allocations of dependency graphs
 
   /* protocol definition */
   Protocol protocols;		//!< List of protocols in the system
@@ -27,6 +27,11 @@
  * so much that this call usually breaks, which is a pretty annoying bug.
  */
 
+#ifndef FORWINDOWS
+// For open_memstream
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -138,3 +143,64 @@ scyther_tempfile (void)
     }
   return fp;
 }
+
+#ifndef FORWINDOWS
+static char *membuffer = NULL;	//!< Contents of the open memory stream
+static size_t membuffersize = 0;	//!< Size of membuffer
+#endif
+
+//! Create a stream that is kept in memory
+/**
+ * Used for output that may be discarded, such as attacks that are superseded
+ * by a cheaper one. Only one such stream can be open at a time. Where
+ * open_memstream is not available, this falls back to a temporary file.
+ */
+FILE *
+scyther_memstream (void)
+{
+#ifdef FORWINDOWS
+  return scyther_tempfile ();
+#else
+  FILE *fp;
+
+  fp = open_memstream (&membuffer, &membuffersize);
+  if (fp == NULL)
+    {
+      error ("Attempt at creating a memory stream failed.");
+    }
+  return fp;
+#endif
+}
+
+//! Write the contents of a stream from scyther_memstream() to another stream
+void
+scyther_memstream_write (FILE * fp, FILE * tostream)
+{
+  fflush (fp);
+#ifdef FORWINDOWS
+  {
+    char block[4096];
+    size_t n;
+
+    fseek (fp, 0, SEEK_SET);
+    while ((n = fread (block, 1, sizeof (block), fp)) > 0)
+      {
+	fwrite (block, 1, n, tostream);
+      }
+  }
+#else
+  fwrite (membuffer, 1, membuffersize, tostream);
+#endif
+}
+
+//! Close a stream from scyther_memstream() and discard its contents
+void
+scyther_memstream_close (FILE * fp)
+{
+  fclose (fp);
+#ifndef FORWINDOWS
+  free (membuffer);
+  membuffer = NULL;
+  membuffersize = 0;
+#endif
+}
@@ -23,5 +23,8 @@
 #include <stdio.h>
 
 FILE *scyther_tempfile (void);
+FILE *scyther_memstream (void);
+void scyther_memstream_write (FILE * fp, FILE * tostream);
+void scyther_memstream_close (FILE * fp);
 
 #endif
@@ -38,6 +38,7 @@
 #include "error.h"
 #include "ctype.h"
 #include "specialterm.h"
+#include "stats.h"
 
 /* public flag */
 int rolelocal_variable;
@@ -79,9 +80,18 @@ termsDone (void)
 Term
 makeTerm ()
 {
+  statsMalloc (MEM_TERMS, sizeof (struct term));
   return (Term) malloc (sizeof (struct term));
 }
 
+//! Free the memory of a single term node, made by makeTerm.
+void
+termFree (const Term term)
+{
+  statsFree (MEM_TERMS, sizeof (struct term));
+  free (term);
+}
+
 //! Create a fresh encrypted term from two existing terms.
 /**
  * The first argument is the message,
@@ -498,7 +508,7 @@ termDuplicate (const Term term)
   if (realTermLeaf (term))
     return term;
 
-  newterm = (Term) malloc (sizeof (struct term));
+  newterm = makeTerm ();
   memcpy (newterm, term, sizeof (struct term));
   if (realTermEncrypt (term))
     {
@@ -530,7 +540,7 @@ termNodeDuplicate (const Term term)
   if (realTermLeaf (term))
     return term;
 
-  newterm = (Term) malloc (sizeof (struct term));
+  newterm = makeTerm ();
   memcpy (newterm, term, sizeof (struct term));
   return newterm;
 }
@@ -551,7 +561,7 @@ termDuplicateDeep (const Term term)
   if (term == NULL)
     return NULL;
 
-  newterm = (Term) malloc (sizeof (struct term));
+  newterm = makeTerm ();
   memcpy (newterm, term, sizeof (struct term));
   if (!realTermLeaf (term))
     {
@@ -585,7 +595,7 @@ termDuplicateUV (Term term)
   if (realTermLeaf (term))
     return term;
 
-  newterm = (Term) malloc (sizeof (struct term));
+  newterm = makeTerm ();
   memcpy (newterm, term, sizeof (struct term));
   if (realTermEncrypt (term))
     {
@@ -609,7 +619,7 @@ realTermDuplicate (const Term term)
   if (term == NULL)
     return NULL;
 
-  newterm = (Term) malloc (sizeof (struct term));
+  newterm = makeTerm ();
   if (realTermLeaf (term))
     {
       memcpy (newterm, term, sizeof (struct term));
@@ -653,7 +663,7 @@ termDelete (const Term term)
 	  termDelete (TermOp1 (term));
 	  termDelete (TermOp2 (term));
 	}
-      free (term);
+      termFree (term);
     }
 }
 
@@ -99,6 +99,8 @@ typedef struct term *Term;
 
 void termsInit (void);
 void termsDone (void);
+Term makeTerm ();
+void termFree (const Term term);
 Term makeTermEncrypt (Term t1, Term t2);
 Term makeTermFcall (Term t1, Term t2);
 Term makeTermTuple (Term t1, Term t2);
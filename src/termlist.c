@@ -25,6 +25,7 @@
 #include "error.h"
 #include "switches.h"
 #include "knowledge.h"
+#include "stats.h"
 
 /*
  * Shared stuff
@@ -66,9 +67,18 @@ Termlist
 makeTermlist ()
 {
   /* inline candidate */
+  statsMalloc (MEM_TERMLISTS, sizeof (struct termlist));
   return (Termlist) malloc (sizeof (struct termlist));
 }
 
+//! Free the memory of a single termlist node.
+static void
+termlistFree (Termlist tl)
+{
+  statsFree (MEM_TERMLISTS, sizeof (struct termlist));
+  free (tl);
+}
+
 //! Duplicate a termlist.
 /**
  * Uses termDuplicate to copy the elements, and allocated new memory for the list nodes.
@@ -134,7 +144,7 @@ termlistDelete (Termlist tl)
     }
 #endif
   termlistDelete (tl->next);
-  free (tl);
+  termlistFree (tl);
 }
 
 
@@ -150,7 +160,7 @@ termlistDestroy (Termlist tl)
     return;
   termlistDestroy (tl->next);
   termDelete (tl->term);
-  free (tl);
+  termlistFree (tl);
 }
 
 //! Determine whether a term is an element of a termlist.
@@ -366,7 +376,7 @@ termlistDelTerm (Termlist tl)
     }
   if (tl->next != NULL)
     (tl->next)->prev = tl->prev;
-  free (tl);
+  termlistFree (tl);
   return newhead;
 }
 
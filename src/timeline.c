@@ -0,0 +1,200 @@
+/*
+ * Scyther : An automatic verifier for security protocols.
+ * Copyright (C) 2007-2025 Cas Cremers
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/**
+ *@file timeline.c
+ * \brief Timeline of the phases of a run (--trace-events)
+ *
+ * Writes the begin and end of each phase (parsing, compiling, the tests of
+ * the claims, rendering attacks and output) as trace events, in the JSON
+ * format of the Chrome trace viewer, which is also read by Perfetto.
+ *
+ * The file is a JSON array with one event per line. It is flushed after
+ * every event and the viewers accept a missing closing bracket, so the
+ * timeline of a run that was killed can still be read.
+ */
+
+/* gettimeofday is not part of C11 */
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <time.h>
+
+#include "timeline.h"
+#include "term.h"
+#include "switches.h"
+#include "error.h"
+
+#if defined(linux) || defined(__linux__) || defined(__APPLE__)
+#define TIMELINE_WALLCLOCK
+#include <sys/time.h>
+#endif
+
+static FILE *timeline = NULL;	//!< Trace event file, NULL if not enabled
+static double timeline_start;	//!< Time of timelineInit, in microseconds
+
+//! Current time in microseconds
+/**
+ * Wall clock time where we have it, otherwise CPU time.
+ */
+static double
+timelineNow (void)
+{
+#ifdef TIMELINE_WALLCLOCK
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return (double) tv.tv_sec * 1000000.0 + (double) tv.tv_usec;
+#else
+  return (double) clock () * 1000000.0 / CLOCKS_PER_SEC;
+#endif
+}
+
+//! Open the timeline file, if one was given
+void
+timelineInit (void)
+{
+  if (switches.traceEvents == NULL)
+    {
+      return;
+    }
+  timeline = fopen (switches.traceEvents, "w");
+  if (timeline == NULL)
+    {
+      error ("Could not open trace event file %s.", switches.traceEvents);
+    }
+  timeline_start = timelineNow ();
+  fprintf (timeline, "[\n");
+  fprintf (timeline,
+	   "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+	   "\"args\":{\"name\":\"scyther\"}}");
+  fflush (timeline);
+}
+
+//! Close the timeline file
+void
+timelineDone (void)
+{
+  if (timeline == NULL)
+    {
+      return;
+    }
+  fprintf (timeline, "\n]\n");
+  fclose (timeline);
+  timeline = NULL;
+}
+
+//! Start an event line
+/**
+ * End events need no name: they close the innermost open phase.
+ */
+static void
+timelineEvent (const char *phase, const char *name)
+{
+  fprintf (timeline, ",\n{");
+  if (name != NULL)
+    {
+      fprintf (timeline, "\"name\":\"%s\",", name);
+    }
+  fprintf (timeline, "\"ph\":\"%s\",\"ts\":%.0f,\"pid\":1,\"tid\":1",
+	   phase, timelineNow () - timeline_start);
+}
+
+//! Name of a term, for the arguments of an event
+/**
+ * The terms are protocol, role and label names, which are identifiers and
+ * need no escaping. Tuples are separated by commas.
+ */
+static void
+timelineTerm (Term t)
+{
+  t = deVar (t);
+  if (realTermLeaf (t))
+    {
+      fprintf (timeline, "%s", TermSymb (t)->text);
+    }
+  else if (realTermTuple (t))
+    {
+      timelineTerm (TermOp1 (t));
+      fprintf (timeline, ",");
+      timelineTerm (TermOp2 (t));
+    }
+  else
+    {
+      fprintf (timeline, "?");
+    }
+}
+
+//! Begin a phase
+void
+timelineBegin (const char *name)
+{
+  if (timeline == NULL)
+    {
+      return;
+    }
+  timelineEvent ("B", name);
+  fprintf (timeline, "}");
+  fflush (timeline);
+}
+
+//! Begin the test of a claim
+/**
+ * The claim is named as in the summary output: protocol, role and the
+ * claim type with its label.
+ */
+void
+timelineBeginClaim (const Claimlist cl)
+{
+  Term label;
+
+  if (timeline == NULL)
+    {
+      return;
+    }
+  label = deVar (cl->label);
+  if (realTermTuple (label))
+    {
+      label = TermOp2 (label);
+    }
+  timelineEvent ("B", "claim");
+  fprintf (timeline, ",\"args\":{\"protocol\":\"");
+  timelineTerm (((Protocol) cl->protocol)->nameterm);
+  fprintf (timeline, "\",\"role\":\"");
+  timelineTerm (cl->rolename);
+  fprintf (timeline, "\",\"claim\":\"");
+  timelineTerm (cl->type);
+  fprintf (timeline, "_");
+  timelineTerm (label);
+  fprintf (timeline, "\"}}");
+  fflush (timeline);
+}
+
+//! End the innermost phase
+void
+timelineEnd (void)
+{
+  if (timeline == NULL)
+    {
+      return;
+    }
+  timelineEvent ("E", NULL);
+  fprintf (timeline, "}");
+  fflush (timeline);
+}
@@ -17,27 +17,113 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+/* setitimer and sigaction are not part of C11 */
+#define _XOPEN_SOURCE 700
+
+#include <time.h>
+#include <stdio.h>
+
 #include "timer.h"
 #include "system.h"
 #include "switches.h"
 #include "symbol.h"
 #include "arachne.h"
+#include "error.h"
 
 /*
  * Timer functions
  *
- * Currently, this only works under linux (where the linux macro is defined by the compiler). Otherwise, it simply assumes the timer is never passed.
+ * The limits are checked at every search node, so this has to be cheap. On
+ * POSIX systems, a profiling timer (which counts CPU time, like times())
+ * ticks every TIMER_TICK_MS and the handler sets flags that are then simply
+ * read. Elsewhere, we fall back to checking clock() every TIMER_CHECK_CALLS
+ * calls, and there is no memory limit.
  */
 
-#ifdef linux
-#include <time.h>
-#include <stdint.h>
-#include <unistd.h>
-#include <sys/times.h>
-static clock_t endwait = 0;
+#if defined(linux) || defined(__linux__) || defined(__APPLE__)
+#define TIMER_SIGNAL
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #endif
 
+#define TIMER_TICK_MS 50
+#define TIMER_CHECK_CALLS 1024
+
 static int time_max_seconds = 0;
+static int memory_max_megabytes = 0;
+
+static volatile sig_atomic_t time_passed = 0;
+
+#ifdef TIMER_SIGNAL
+static volatile sig_atomic_t timer_ticks = 0;
+static volatile sig_atomic_t memory_check = 0;
+static int memory_passed = 0;
+static int timer_running = false;
+
+//! Profiling timer tick
+static void
+timer_handler (int signum)
+{
+  timer_ticks++;
+  if (time_max_seconds > 0
+      && (long) timer_ticks * TIMER_TICK_MS >= time_max_seconds * 1000L)
+    {
+      time_passed = 1;
+    }
+  memory_check = 1;
+}
+
+//! Start the profiling timer, if not running yet
+static void
+timer_start (void)
+{
+  struct sigaction sa;
+  struct itimerval it;
+
+  if (timer_running)
+    {
+      return;
+    }
+  sa.sa_handler = timer_handler;
+  sigemptyset (&sa.sa_mask);
+  // Do not break any I/O we are doing at the time
+  sa.sa_flags = SA_RESTART;
+  if (sigaction (SIGPROF, &sa, NULL) != 0)
+    {
+      error ("Could not install the timer signal handler.");
+    }
+  it.it_interval.tv_sec = 0;
+  it.it_interval.tv_usec = TIMER_TICK_MS * 1000;
+  it.it_value = it.it_interval;
+  if (setitimer (ITIMER_PROF, &it, NULL) != 0)
+    {
+      error ("Could not start the timer.");
+    }
+  timer_running = true;
+}
+
+//! Peak resident set size in kilobytes, according to getrusage
+/**
+ * On Linux this includes the peak of the process before it executed us.
+ */
+static long
+rusage_peak_kilobytes (void)
+{
+  struct rusage ru;
+
+  getrusage (RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+  // In bytes
+  return (long) (ru.ru_maxrss / 1024);
+#else
+  // In kilobytes
+  return (long) ru.ru_maxrss;
+#endif
+}
+#else
+static int check_countdown = 0;
+#endif
 
 //! Set initial time limit.
 /**
@@ -49,17 +135,15 @@ set_time_limit (int seconds)
   if (seconds > 0)
     {
       time_max_seconds = seconds;
-#ifdef linux
-      endwait = seconds * sysconf (_SC_CLK_TCK);
+#ifdef TIMER_SIGNAL
+      timer_start ();
 #endif
     }
   else
     {
       time_max_seconds = 0;
-#ifdef linux
-      endwait = 0;
-#endif
     }
+  time_passed = 0;
 }
 
 //! Retrieve time limit
@@ -73,28 +157,113 @@ get_time_limit ()
 int
 passed_time_limit ()
 {
-#ifdef linux
-  if (endwait <= 0)
+#ifndef TIMER_SIGNAL
+  if (time_max_seconds > 0 && !time_passed)
+    {
+      check_countdown--;
+      if (check_countdown <= 0)
+	{
+	  check_countdown = TIMER_CHECK_CALLS;
+	  if (clock () / CLOCKS_PER_SEC >= time_max_seconds)
+	    {
+	      time_passed = 1;
+	    }
+	}
+    }
+#endif
+  return time_passed;
+}
+
+//! Set memory limit in megabytes.
+/**
+ * <= 0 means none.
+ */
+void
+set_memory_limit (int megabytes)
+{
+  if (megabytes > 0)
     {
-      return 0;
+      memory_max_megabytes = megabytes;
+#ifdef TIMER_SIGNAL
+      timer_start ();
+#else
+      warning ("--max-memory is not supported on this platform.");
+#endif
     }
   else
     {
-      struct tms t;
+      memory_max_megabytes = 0;
+    }
+}
 
-      times (&t);
-      if ((t.tms_utime + t.tms_stime) > endwait)
-	return 1;
-      else if (switches.output == PROOF)
+//! Retrieve memory limit
+int
+get_memory_limit ()
+{
+  return memory_max_megabytes;
+}
+
+//! Check whether the memory limit has passed.
+/**
+ * Uses the peak resident set size of this process, which is only queried
+ * once per timer tick.
+ */
+int
+passed_memory_limit ()
+{
+#ifdef TIMER_SIGNAL
+  if (memory_check)
+    {
+      memory_check = 0;
+      if (memory_max_megabytes > 0
+	  && peak_memory_kilobytes () / 1024 >= memory_max_megabytes)
 	{
-	  indentPrint ();
-	  eprintf ("Clockticks per second: %jd\tTicks passed: %jd\n",
-		   (intmax_t) (sysconf (_SC_CLK_TCK)),
-		   (intmax_t) (t.tms_utime + t.tms_stime));
+	  memory_passed = 1;
 	}
-      return 0;
     }
+  return memory_passed;
 #else
   return 0;
 #endif
 }
+
+//! Peak resident set size in kilobytes, or -1 if unknown.
+/**
+ * On Linux, this is read from /proc, because the rusage figure also
+ * includes the memory of the process before it executed us.
+ */
+long
+peak_memory_kilobytes ()
+{
+#if defined(linux) || defined(__linux__)
+  FILE *fp;
+  char line[128];
+  long kb;
+
+  kb = -1;
+  fp = fopen ("/proc/self/status", "r");
+  if (fp != NULL)
+    {
+      while (fgets (line, sizeof (line), fp) != NULL)
+	{
+	  if (sscanf (line, "VmHWM: %ld", &kb) == 1)
+	    {
+	      break;
+	    }
+	}
+      fclose (fp);
+    }
+  if (kb < 0)
+    {
+      // No /proc; better an overestimate than no limit at all
+      kb = rusage_peak_kilobytes ();
+    }
+  return kb;
+#else
+#ifdef TIMER_SIGNAL
+  return rusage_peak_kilobytes ();
+#else
+  return -1;
+#endif
+#endif
+}
@@ -23,5 +23,9 @@
 void set_time_limit (int seconds);
 int get_time_limit ();
 int passed_time_limit ();
+void set_memory_limit (int megabytes);
+int get_memory_limit ();
+int passed_memory_limit ();
+long peak_memory_kilobytes ();
 
 #endif
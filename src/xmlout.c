@@ -41,6 +41,7 @@
 #include "claim.h"
 #include "dotout.h"
 #include "type.h"
+#include "stats.h"
 
 #include "xmlout.h"
 
@@ -76,6 +77,7 @@ void
 xmlOutDone (void)
 {
   eprintf ("</scyther>\n");
+  eflush ();
 }
 
 /*
@@ -1041,8 +1043,81 @@ xmlOutClaim (const System sys, Claimlist cl)
 	{
 	  xmlPrint ("<timebound />");
 	}
+      if (cl->membound)
+	{
+	  xmlPrint ("<membound />");
+	}
+      if (cl->statebound)
+	{
+	  xmlOutStates ("statebound", switches.maxStates);
+	}
     }
 
   xmlindent--;
   xmlPrint ("</claimstatus>");
 }
+
+//! Output the runs created for the roles of a protocol
+static void
+xmlOutRoleRuns (const Protocol p)
+{
+  Role r;
+
+  for (r = p->roles; r != NULL; r = r->next)
+    {
+      if (r->created > 0)
+	{
+	  xmlIndentPrint ();
+	  eprintf ("<runs protocol=\"%s\" role=\"%s\">",
+		   TermSymb (p->nameterm)->text, TermSymb (r->nameterm)->text);
+	  statesFormat (r->created);
+	  eprintf ("</runs>\n");
+	}
+    }
+}
+
+//! Output the counters of the search (--stats)
+void
+xmlOutStatistics (const System sys)
+{
+  Protocol p;
+  int rule;
+
+  xmlPrint ("<statistics>");
+  xmlindent++;
+  xmlOutStates ("states", sys->states);
+  xmlOutStates ("unify", stats.unify);
+  xmlOutStates ("unifiers", stats.unifiers);
+  xmlOutStates ("subtermunify", stats.subterm_unify);
+  xmlOutStates ("subtermunifiers", stats.subterm_unifiers);
+  xmlOutStates ("dependpushes", stats.depend_pushes);
+  xmlOutStates ("dependzombies", stats.depend_zombies);
+  xmlOutStates ("dependcycles", stats.depend_cycles);
+  xmlOutStates ("closures", stats.closures);
+  xmlOutStates ("dependgraphs", sys->depend_graphs);
+  xmlOutStates ("dependallocations", sys->depend_allocations);
+  xmlOutStates ("goalsadded", stats.goals_added);
+  xmlOutStates ("goalbinds", stats.goal_binds);
+  xmlOutStates ("goalbindsdone", stats.goal_binds_done);
+  xmlOutStates ("runchanges", sys->run_changes);
+  xmlOutStates ("runallocations", sys->run_allocations);
+  xmlOutStates ("terms", stats.memory[MEM_TERMS].allocations);
+  xmlOutStates ("termlists", stats.memory[MEM_TERMLISTS].allocations);
+  for (rule = 0; rule < PRUNE_RULES; rule++)
+    {
+      if (stats.prunes[rule] > 0)
+	{
+	  xmlIndentPrint ();
+	  eprintf ("<prune rule=\"%s\">", statsPruneName (rule));
+	  statesFormat (stats.prunes[rule]);
+	  eprintf ("</prune>\n");
+	}
+    }
+  for (p = sys->protocols; p != NULL; p = p->next)
+    {
+      xmlOutRoleRuns (p);
+    }
+  xmlOutRoleRuns (INTRUDER);
+  xmlindent--;
+  xmlPrint ("</statistics>");
+}
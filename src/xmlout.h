@@ -28,5 +28,9 @@ void xmlOutDone (void);
 
 void xmlOutSemitrace (const System sys);
 void xmlOutClaim (const System sys, Claimlist cl);
+void xmlOutStatistics (const System sys);
+
+int showthis (const System sys, const int run, const Roledef rd,
+	      const int index);
 
 #endif